@@ -0,0 +1,343 @@
+//=========================================================================================
+// enlilBenchmark
+//
+// Times vtkEnlilReader on a run (for example one written by enlilGenerate):
+//  - RequestInformation of the series: the time scan with the sidecar time index removed
+//    (cold), then by a second reader with the index the first one left (warm)
+//  - a full RequestData of the first time step
+//  - a sub-extent (the middle half of every dimension)
+//  - the periodic wedge (the last phi planes, which wrap around to file plane 0)
+//  - every time step in order, and in random order
+// Every phase reports seconds per update, the size of the output, the throughput and the
+// peak resident set size of the process so far.  The array cache is off by default, and
+// the arrays the reader keeps from the previous update are released before every update,
+// so repeated reads go to the files.
+//
+// usage: enlilBenchmark [-n repeats] [-c cacheMB] [-r resolution] [-prefetch] directory|files
+//=========================================================================================
+
+#include "vtkEnlilReader.h"
+#include "readerTimeIndex.h"
+
+#include "vtkDataArray.h"
+#include "vtkInformation.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkStructuredGrid.h"
+#include "vtkTimerLog.h"
+#include "vtksys/Directory.hxx"
+#include "vtksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+//-----------------------------------------------------------------------------------------
+//peak resident set size of the process in MB (0 where unknown)
+static double peakMemory()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss/(1024.0*1024.0);     //bytes
+#else
+    return usage.ru_maxrss/1024.0;              //KB
+#endif
+#endif
+}
+
+//-----------------------------------------------------------------------------------------
+//size of the points and point arrays of the output in MB
+static double outputSize(vtkStructuredGrid* grid)
+{
+    double bytes = 0;
+
+    if(grid->GetPoints() != NULL)
+    {
+        vtkDataArray* points = grid->GetPoints()->GetData();
+        bytes += (double)points->GetNumberOfTuples()*points->GetNumberOfComponents()*points->GetDataTypeSize();
+    }
+
+    vtkPointData* pointData = grid->GetPointData();
+    for(int x = 0; x < pointData->GetNumberOfArrays(); x++)
+    {
+        vtkDataArray* array = pointData->GetArray(x);
+        if(array != NULL)
+        {
+            bytes += (double)array->GetNumberOfTuples()*array->GetNumberOfComponents()*array->GetDataTypeSize();
+        }
+    }
+
+    return bytes/(1024*1024);
+}
+
+//-----------------------------------------------------------------------------------------
+//accumulated timing of one phase
+struct phase
+{
+    phase(const std::string &_name) : name(_name), updates(0), seconds(0), megabytes(0) {}
+
+    std::string name;
+    int updates;
+    double seconds;
+    double megabytes;
+
+    void report() const
+    {
+        double perUpdate = (this->updates > 0) ? this->seconds/this->updates : 0;
+        double throughput = (this->seconds > 0) ? this->megabytes/this->seconds : 0;
+
+        std::cout << std::left << std::setw(22) << this->name << std::right
+                  << std::setw(8) << this->updates
+                  << std::setw(14) << std::fixed << std::setprecision(4) << perUpdate
+                  << std::setw(12) << std::setprecision(1) << (this->updates > 0 ? this->megabytes/this->updates : 0)
+                  << std::setw(12) << throughput
+                  << std::setw(12) << peakMemory() << std::endl;
+    }
+};
+
+//-----------------------------------------------------------------------------------------
+//reads extent of time step time, and adds the timing to result
+static void timeUpdate(vtkEnlilReader* reader, double time, const int extent[6], phase &result)
+{
+    //read again, even if the same request was made before.  Only the arrays of the last
+    //  update are released, the cache (-c) still serves what it holds.
+    reader->ReleaseCurrentArrays();
+    reader->UpdateInformation();
+
+    vtkStreamingDemandDrivenPipeline* executive
+            = vtkStreamingDemandDrivenPipeline::SafeDownCast(reader->GetExecutive());
+    executive->SetUpdateTimeStep(0, time);
+    executive->SetUpdateExtent(0, (int*)extent);
+
+    double start = vtkTimerLog::GetUniversalTime();
+    reader->Update();
+    result.seconds += vtkTimerLog::GetUniversalTime() - start;
+
+    result.updates++;
+    result.megabytes += outputSize(reader->GetOutput());
+}
+
+//-----------------------------------------------------------------------------------------
+//all .nc files of directory, in name order
+static std::vector<std::string> listRun(const std::string &directory)
+{
+    std::vector<std::string> files;
+
+    vtksys::Directory listing;
+    if(listing.Load(directory))
+    {
+        for(unsigned long x = 0; x < listing.GetNumberOfFiles(); x++)
+        {
+            std::string name = listing.GetFile(x);
+            if(vtksys::SystemTools::GetFilenameLastExtension(name) == ".nc")
+            {
+                files.push_back(directory + "/" + name);
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+//-----------------------------------------------------------------------------------------
+static void usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [-n repeats] [-c cacheMB] [-r resolution] [-prefetch] directory|files" << std::endl
+              << "  -n repeats     updates per single step phase (default 3)" << std::endl
+              << "  -c cacheMB     reader cache size (default 0, every update reads the files)" << std::endl
+              << "  -r resolution  reader resolution stride (default 1)" << std::endl
+              << "  -prefetch      read the next time step in the background" << std::endl;
+}
+
+//=========================================================================================
+int main(int argc, char* argv[])
+{
+    int repeats = 3;
+    int cacheSize = 0;
+    int resolution = 1;
+    int prefetch = 0;
+
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-'; arg++)
+    {
+        if(strcmp(argv[arg], "-prefetch") == 0)
+        {
+            prefetch = 1;
+        }
+        else if(arg+1 < argc && strcmp(argv[arg], "-n") == 0)
+        {
+            repeats = std::max(1, atoi(argv[++arg]));
+        }
+        else if(arg+1 < argc && strcmp(argv[arg], "-c") == 0)
+        {
+            cacheSize = std::max(0, atoi(argv[++arg]));
+        }
+        else if(arg+1 < argc && strcmp(argv[arg], "-r") == 0)
+        {
+            resolution = std::max(1, atoi(argv[++arg]));
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::string> files;
+    if(arg == argc-1 && vtksys::SystemTools::FileIsDirectory(argv[arg]))
+    {
+        files = listRun(argv[arg]);
+    }
+    else
+    {
+        files.assign(argv+arg, argv+argc);
+    }
+
+    if(files.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    vtkSmartPointer<vtkEnlilReader> reader = vtkSmartPointer<vtkEnlilReader>::New();
+    reader->SetCacheSize(cacheSize);
+    reader->SetPrefetch(prefetch);
+    reader->SetResolution(resolution);
+
+    for(size_t x = 0; x < files.size(); x++)
+    {
+        reader->AddFileName(files[x].c_str());
+    }
+
+    std::cout << files.size() << " files, cache " << cacheSize << " MB, resolution " << resolution
+              << ", prefetch " << (prefetch ? "on" : "off") << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(22) << "phase" << std::right
+              << std::setw(8) << "updates"
+              << std::setw(14) << "s/update"
+              << std::setw(12) << "MB/update"
+              << std::setw(12) << "MB/s"
+              << std::setw(12) << "peak MB" << std::endl;
+
+    //time scan of every file: without the index an earlier run left next to the files
+    vtksys::SystemTools::RemoveFile(readerTimeIndex::getIndexFileName(files[0]).c_str());
+
+    phase information("RequestInformation");
+    double start = vtkTimerLog::GetUniversalTime();
+    reader->UpdateInformation();
+    information.seconds = vtkTimerLog::GetUniversalTime() - start;
+    information.updates = 1;
+    information.report();
+
+    //and from the index the scan just saved (unless the run directory is read-only)
+    {
+        vtkSmartPointer<vtkEnlilReader> indexed = vtkSmartPointer<vtkEnlilReader>::New();
+        for(size_t x = 0; x < files.size(); x++)
+        {
+            indexed->AddFileName(files[x].c_str());
+        }
+
+        phase warm("  from time index");
+        start = vtkTimerLog::GetUniversalTime();
+        indexed->UpdateInformation();
+        warm.seconds = vtkTimerLog::GetUniversalTime() - start;
+        warm.updates = 1;
+        warm.report();
+    }
+
+    reader->EnableAllPointArrays();
+    reader->UpdateInformation();
+
+    vtkInformation* outInfo = reader->GetOutputInformation(0);
+
+    int wholeExtent[6];
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+
+    std::vector<double> times;
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::TIME_STEPS()))
+    {
+        int numberOfTimes = outInfo->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+        double* steps = outInfo->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+        times.assign(steps, steps + numberOfTimes);
+    }
+    if(times.empty())
+    {
+        //a single file does not advertise its time
+        times.push_back(0);
+    }
+
+    //full volume
+    phase full("Full RequestData");
+    for(int x = 0; x < repeats; x++)
+    {
+        timeUpdate(reader, times[0], wholeExtent, full);
+    }
+    full.report();
+
+    //middle half of every dimension
+    int subExtent[6];
+    for(int d = 0; d < 3; d++)
+    {
+        int length = wholeExtent[2*d+1] - wholeExtent[2*d];
+        subExtent[2*d] = wholeExtent[2*d] + length/4;
+        subExtent[2*d+1] = wholeExtent[2*d] + (3*length)/4;
+    }
+
+    phase sub("Sub-extent");
+    for(int x = 0; x < repeats; x++)
+    {
+        timeUpdate(reader, times[0], subExtent, sub);
+    }
+    sub.report();
+
+    //last two phi planes: one from the file, plus the periodic plane
+    int wedgeExtent[6];
+    std::copy(wholeExtent, wholeExtent+6, wedgeExtent);
+    wedgeExtent[4] = std::max(wholeExtent[4], wholeExtent[5]-1);
+
+    phase wedge("Periodic wedge");
+    for(int x = 0; x < repeats; x++)
+    {
+        timeUpdate(reader, times[0], wedgeExtent, wedge);
+    }
+    wedge.report();
+
+    //every time step, in order and shuffled
+    phase sequential("Sequential time");
+    for(size_t x = 0; x < times.size(); x++)
+    {
+        timeUpdate(reader, times[x], wholeExtent, sequential);
+    }
+    sequential.report();
+
+    std::vector<double> shuffled(times);
+    srand(1);
+    std::random_shuffle(shuffled.begin(), shuffled.end());
+
+    phase randomTime("Random time");
+    for(size_t x = 0; x < shuffled.size(); x++)
+    {
+        timeUpdate(reader, shuffled[x], wholeExtent, randomTime);
+    }
+    randomTime.report();
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+//=========================================================================================
+// enlilGenerate
+//
+// Writes a synthetic ENLIL run: one classic NetCDF file per time step with the layout
+// vtkEnlilReader expects (X1/X2/X3, D, DP, T, BP, B1-3, V1-3, TIME and refdate_mjd).
+// The fields are a steady Parker spiral solar wind with a dense, fast cloud moving out
+// through it, so the data is smooth like a real run and compresses like one.
+//
+// usage: enlilGenerate [-r n] [-t n] [-p n] [-s steps] [-f] outputDirectory
+//=========================================================================================
+
+#include "vtk_netcdf.h"
+#include "vtksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define AU 1.5e11
+#define PI 3.14159265358979323846
+
+//solar rotation rate (rad/s) and reference date of the run
+#define OMEGA_SUN 2.7e-6
+#define REFDATE_MJD 57000.0
+
+//seconds between time steps
+#define STEP_SECONDS 3600.0
+
+//-----------------------------------------------------------------------------------------
+//size and type of the generated run
+struct runShape
+{
+    int numR;
+    int numTheta;
+    int numPhi;
+    int numSteps;
+    nc_type type;
+};
+
+//-----------------------------------------------------------------------------------------
+static bool check(int status, const std::string &what)
+{
+    if(status != NC_NOERR)
+    {
+        std::cerr << what << ": " << nc_strerror(status) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------
+static int putText(int ncid, int varID, const char* name, const char* value)
+{
+    return nc_put_att_text(ncid, varID, name, strlen(value), value);
+}
+
+//-----------------------------------------------------------------------------------------
+//the solar wind at (r, theta, phi) and time (seconds since the reference date)
+struct plasma
+{
+    double D, DP, T, BP;
+    double B[3];
+    double V[3];
+};
+
+static void solarWind(double r, double theta, double phi, double time, plasma &p)
+{
+    const double r0 = 0.1*AU;
+    const double scale = r0/r;
+
+    //a cloud launched at the reference date, centered on phi = 0, theta = 90
+    const double cloudSpeed = 8e5;
+    const double cloudR = r0 + cloudSpeed*time;
+    const double dr = (r - cloudR)/(0.05*AU);
+    const double da = (theta - PI/2)*(theta - PI/2) + (1 - cos(phi));
+    const double cloud = exp(-dr*dr - da/0.05);
+
+    const double speed = 4e5 + (cloudSpeed-4e5)*cloud;
+
+    p.D = 1e-20*scale*scale*(1 + 3*cloud);
+    p.DP = 1e-20*scale*scale*cloud;
+    p.T = 1e5*pow(scale, 4.0/3.0);
+    p.BP = (theta < PI/2) ? 1 : -1;
+
+    //parker spiral
+    const double Br = p.BP*5e-8*scale*scale;
+    p.B[0] = Br;
+    p.B[1] = 0;
+    p.B[2] = -Br*OMEGA_SUN*r*sin(theta)/speed;
+
+    p.V[0] = speed;
+    p.V[1] = 0;
+    p.V[2] = 0;
+}
+
+//-----------------------------------------------------------------------------------------
+//writes one time step of the run to fileName
+static bool writeStep(const std::string &fileName, const runShape &shape, int step)
+{
+    int ncid = 0;
+    if(!check(nc_create(fileName.c_str(), NC_CLOBBER | NC_64BIT_OFFSET, &ncid), fileName))
+    {
+        return false;
+    }
+
+    const double time = step*STEP_SECONDS;
+
+    //grid: cell centers from 0.1 to 2 AU, 30 to 150 degrees colatitude, all longitudes
+    std::vector<double> X1(shape.numR), X2(shape.numTheta), X3(shape.numPhi);
+    for(int i = 0; i < shape.numR; i++)
+    {
+        X1[i] = (0.1 + 1.9*(i+0.5)/shape.numR)*AU;
+    }
+    for(int j = 0; j < shape.numTheta; j++)
+    {
+        X2[j] = PI/6 + (2*PI/3)*(j+0.5)/shape.numTheta;
+    }
+    for(int k = 0; k < shape.numPhi; k++)
+    {
+        X3[k] = 2*PI*(k+0.5)/shape.numPhi;
+    }
+
+    //dimensions: r, theta and phi first (the reader takes the grid size from them)
+    int dims[4];
+    bool ok = check(nc_def_dim(ncid, "n1", shape.numR, &dims[0]), "n1")
+            && check(nc_def_dim(ncid, "n2", shape.numTheta, &dims[1]), "n2")
+            && check(nc_def_dim(ncid, "n3", shape.numPhi, &dims[2]), "n3")
+            && check(nc_def_dim(ncid, "t", NC_UNLIMITED, &dims[3]), "t");
+
+    double refdate = REFDATE_MJD;
+    ok = ok && check(nc_put_att_double(ncid, NC_GLOBAL, "refdate_mjd", NC_DOUBLE, 1, &refdate), "refdate_mjd")
+            && check(putText(ncid, NC_GLOBAL, "type", "synthetic ENLIL run (enlilGenerate)"), "type");
+
+    //coordinates and time
+    int timeID = 0;
+    int gridIDs[3];
+    const char* gridNames[3] = {"X1", "X2", "X3"};
+    const char* gridLongNames[3] = {"radial coordinate", "colatitude", "longitude"};
+    const char* gridUnits[3] = {"m", "radian", "radian"};
+
+    ok = ok && check(nc_def_var(ncid, "TIME", NC_DOUBLE, 1, &dims[3], &timeID), "TIME")
+            && check(putText(ncid, timeID, "long_name", "time since the reference date"), "TIME")
+            && check(putText(ncid, timeID, "units", "s"), "TIME");
+
+    for(int x = 0; ok && x < 3; x++)
+    {
+        int gridDims[2] = {dims[3], dims[x]};
+        ok = check(nc_def_var(ncid, gridNames[x], NC_DOUBLE, 2, gridDims, &gridIDs[x]), gridNames[x])
+                && check(putText(ncid, gridIDs[x], "long_name", gridLongNames[x]), gridNames[x])
+                && check(putText(ncid, gridIDs[x], "units", gridUnits[x]), gridNames[x]);
+    }
+
+    //fields: (time, phi, theta, r), with the long names the reader groups them by
+    const int numFields = 10;
+    const char* names[numFields] = {"D", "DP", "T", "BP", "B1", "B2", "B3", "V1", "V2", "V3"};
+    const char* longNames[numFields] = {"Density", "Density of cloud", "Temperature", "Polarity",
+                                        "X1-Magnetic field", "X2-Magnetic field", "X3-Magnetic field",
+                                        "X1-Velocity", "X2-Velocity", "X3-Velocity"};
+    const char* units[numFields] = {"kg/m3", "kg/m3", "K", "", "T", "T", "T", "m/s", "m/s", "m/s"};
+    int fieldIDs[numFields];
+    int fieldDims[4] = {dims[3], dims[2], dims[1], dims[0]};
+
+    for(int f = 0; ok && f < numFields; f++)
+    {
+        ok = check(nc_def_var(ncid, names[f], shape.type, 4, fieldDims, &fieldIDs[f]), names[f])
+                && check(putText(ncid, fieldIDs[f], "long_name", longNames[f]), names[f])
+                && check(putText(ncid, fieldIDs[f], "units", units[f]), names[f]);
+    }
+
+    ok = ok && check(nc_enddef(ncid), fileName);
+
+    //grid and time
+    size_t start[4] = {0, 0, 0, 0};
+    size_t count[4] = {1, 1, 1, 1};
+
+    ok = ok && check(nc_put_vara_double(ncid, timeID, start, count, &time), "TIME");
+
+    const std::vector<double>* grid[3] = {&X1, &X2, &X3};
+    for(int x = 0; ok && x < 3; x++)
+    {
+        count[1] = grid[x]->size();
+        ok = check(nc_put_vara_double(ncid, gridIDs[x], start, count, &(*grid[x])[0]), gridNames[x]);
+    }
+
+    //fields, one phi plane at a time
+    const size_t planeSize = (size_t)shape.numR*shape.numTheta;
+    std::vector<std::vector<double> > planes(numFields, std::vector<double>(planeSize));
+
+    count[1] = 1;
+    count[2] = shape.numTheta;
+    count[3] = shape.numR;
+
+    for(int k = 0; ok && k < shape.numPhi; k++)
+    {
+        for(int j = 0; j < shape.numTheta; j++)
+        {
+            for(int i = 0; i < shape.numR; i++)
+            {
+                plasma p;
+                solarWind(X1[i], X2[j], X3[k], time, p);
+
+                const size_t index = (size_t)j*shape.numR + i;
+                planes[0][index] = p.D;
+                planes[1][index] = p.DP;
+                planes[2][index] = p.T;
+                planes[3][index] = p.BP;
+                for(int c = 0; c < 3; c++)
+                {
+                    planes[4+c][index] = p.B[c];
+                    planes[7+c][index] = p.V[c];
+                }
+            }
+        }
+
+        //the library converts to the type of the variable
+        start[1] = k;
+        for(int f = 0; ok && f < numFields; f++)
+        {
+            ok = check(nc_put_vara_double(ncid, fieldIDs[f], start, count, &planes[f][0]), names[f]);
+        }
+    }
+
+    ok = check(nc_close(ncid), fileName) && ok;
+    return ok;
+}
+
+//-----------------------------------------------------------------------------------------
+static void usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [-r n] [-t n] [-p n] [-s steps] [-f] outputDirectory" << std::endl
+              << "  -r n      radial points (default 256)" << std::endl
+              << "  -t n      theta points (default 60)" << std::endl
+              << "  -p n      phi points (default 180)" << std::endl
+              << "  -s steps  number of time steps (default 10)" << std::endl
+              << "  -f        write float instead of double fields" << std::endl;
+}
+
+//=========================================================================================
+int main(int argc, char* argv[])
+{
+    runShape shape;
+    shape.numR = 256;
+    shape.numTheta = 60;
+    shape.numPhi = 180;
+    shape.numSteps = 10;
+    shape.type = NC_DOUBLE;
+
+    int arg = 1;
+    for(; arg < argc-1 && argv[arg][0] == '-'; arg++)
+    {
+        if(strcmp(argv[arg], "-f") == 0)
+        {
+            shape.type = NC_FLOAT;
+            continue;
+        }
+
+        int* value = NULL;
+        if(strcmp(argv[arg], "-r") == 0)      value = &shape.numR;
+        else if(strcmp(argv[arg], "-t") == 0) value = &shape.numTheta;
+        else if(strcmp(argv[arg], "-p") == 0) value = &shape.numPhi;
+        else if(strcmp(argv[arg], "-s") == 0) value = &shape.numSteps;
+
+        if(value == NULL || arg+1 >= argc-1)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+
+        *value = std::max(2, atoi(argv[++arg]));
+    }
+
+    if(arg != argc-1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string directory = argv[arg];
+    if(!vtksys::SystemTools::MakeDirectory(directory))
+    {
+        std::cerr << "Cannot create " << directory << std::endl;
+        return 1;
+    }
+
+    double megabytes = (double)shape.numR*shape.numTheta*shape.numPhi*10
+            *(shape.type == NC_FLOAT ? 4 : 8)/(1024*1024);
+    std::cout << "Writing " << shape.numSteps << " steps of " << shape.numR << " x " << shape.numTheta
+              << " x " << shape.numPhi << " (" << megabytes << " MB each) to " << directory << std::endl;
+
+    for(int step = 0; step < shape.numSteps; step++)
+    {
+        char name[64];
+        sprintf(name, "/tim.%04d.nc", step);
+
+        if(!writeStep(directory + name, shape, step))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
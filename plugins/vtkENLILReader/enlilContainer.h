@@ -0,0 +1,16 @@
+#ifndef ENLILCONTAINER_H
+#define ENLILCONTAINER_H
+
+//names shared by enlilConverter and vtkEnlilReader for the single file (NetCDF-4)
+// container that holds a whole ENLIL run, one record per time step.
+namespace CONTAINER
+{
+//global attribute marking a container.  Its value is the layout version.
+static const char* const Attribute = "enlil_container";
+static const char* const Version = "1";
+
+//record variable with the modified julian date of every time step
+static const char* const TimeIndex = "TIME_MJD";
+}
+
+#endif // ENLILCONTAINER_H
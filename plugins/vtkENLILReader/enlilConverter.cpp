@@ -0,0 +1,583 @@
+//=========================================================================================
+// enlilConverter
+//
+// Rewrites a series of ENLIL files (one time step per file) into one NetCDF-4 container
+// that vtkEnlilReader opens as a single time series:
+//  - the 3d fields (time, phi, theta, r) are stored as float, cut into chunks along all
+//    three grid dimensions, so full volumes as well as constant theta and constant r
+//    slabs only decompress the chunks they touch
+//  - every variable is shuffled and deflated
+//  - TIME_MJD holds the modified julian date of every record, so the time steps are
+//    known without reading a single field
+// The records are sorted by time.  Global attributes are taken from the earliest file.
+//
+// usage: enlilConverter [-d level] [-c values] output.nc input.nc [input.nc ...]
+//=========================================================================================
+
+#include "vtk_netcdf.h"
+
+#include "DateTime.h"
+#include "enlilContainer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//default number of values in a chunk of a 3d field (256 KB of floats)
+#define ENLIL_CHUNK_VALUES (1 << 16)
+
+//default deflate level.  Higher levels cost a lot of write time for little gain.
+#define ENLIL_DEFLATE_LEVEL 4
+
+//-----------------------------------------------------------------------------------------
+//a file of the series and the time of its record
+struct inputFile
+{
+    std::string fileName;
+    double mjd;
+};
+
+static bool earlier(const inputFile &a, const inputFile &b)
+{
+    return a.mjd < b.mjd;
+}
+
+//-----------------------------------------------------------------------------------------
+//how a variable of the template file is stored in the container
+struct variablePlan
+{
+    std::string name;
+    int outputID;
+    nc_type type;                  //type in the source files
+    bool isRecord;                 //first dimension is time
+    bool isField;                  //(time, phi, theta, r) float/double, stored as float
+    std::vector<size_t> shape;     //one record (without the time dimension)
+    size_t chunkPlanes;            //phi planes per chunk of a field
+};
+
+//-----------------------------------------------------------------------------------------
+static bool check(int status, const std::string &what)
+{
+    if(status != NC_NOERR)
+    {
+        std::cerr << what << ": " << nc_strerror(status) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------
+static size_t typeSize(nc_type type)
+{
+    switch(type)
+    {
+    case NC_BYTE:
+    case NC_CHAR:
+        return 1;
+    case NC_SHORT:
+        return 2;
+    case NC_INT:
+    case NC_FLOAT:
+        return 4;
+    case NC_DOUBLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+//time of the (first) record of fileName, computed the same way vtkEnlilReader does
+static bool readFileTime(const std::string &fileName, double &mjd)
+{
+    int ncid = 0;
+    if(nc_open(fileName.c_str(), NC_NOWRITE, &ncid) != NC_NOERR)
+    {
+        return false;
+    }
+
+    double refMJD = 0;
+    double time = 0;
+    int timeID = 0;
+    size_t first = 0;
+
+    bool found = nc_get_att_double(ncid, NC_GLOBAL, "refdate_mjd", &refMJD) == NC_NOERR
+            && nc_inq_varid(ncid, "TIME", &timeID) == NC_NOERR
+            && nc_get_var1_double(ncid, timeID, &first, &time) == NC_NOERR;
+
+    nc_close(ncid);
+
+    if(found)
+    {
+        DateTime refDate(refMJD);
+        refDate.incrementSeconds(time);
+        mjd = refDate.getMJD();
+    }
+
+    return found;
+}
+
+//-----------------------------------------------------------------------------------------
+//chunk shape (phi, theta, r) of a field: start from the whole volume and halve the
+// longest side until a chunk holds at most maxValues values.  The chunks end up close
+// to cubes, so no access direction has to decompress much more than it reads.
+static void chooseChunks(const size_t dims[3], size_t maxValues, size_t chunks[3])
+{
+    for(int x = 0; x < 3; x++)
+    {
+        chunks[x] = std::max<size_t>(dims[x], 1);
+    }
+
+    while(chunks[0]*chunks[1]*chunks[2] > maxValues)
+    {
+        int longest = 0;
+        for(int x = 1; x < 3; x++)
+        {
+            if(chunks[x] > chunks[longest])
+            {
+                longest = x;
+            }
+        }
+
+        if(chunks[longest] == 1)
+        {
+            break;
+        }
+
+        chunks[longest] = (chunks[longest]+1)/2;
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+//copies the attributes of variable varID (or NC_GLOBAL) from source to output.
+// The fill value of a field converted to float has to become a float as well.
+static bool copyAttributes(int source, int varID, int output, int outputID, bool toFloat)
+{
+    int natts = 0;
+    int status = (varID == NC_GLOBAL) ? nc_inq_natts(source, &natts) : nc_inq_varnatts(source, varID, &natts);
+
+    for(int x = 0; status == NC_NOERR && x < natts; x++)
+    {
+        char name[NC_MAX_NAME+1];
+        status = nc_inq_attname(source, varID, x, name);
+        if(status != NC_NOERR)
+        {
+            break;
+        }
+
+        nc_type type;
+        size_t length = 0;
+        status = nc_inq_att(source, varID, name, &type, &length);
+
+        if(status == NC_NOERR && toFloat && type == NC_DOUBLE && strcmp(name, "_FillValue") == 0)
+        {
+            double fill = 0;
+            status = nc_get_att_double(source, varID, name, &fill);
+
+            float value = (float)fill;
+            if(status == NC_NOERR)
+            {
+                status = nc_put_att_float(output, outputID, name, NC_FLOAT, 1, &value);
+            }
+        }
+        else if(status == NC_NOERR)
+        {
+            status = nc_copy_att(source, varID, name, output, outputID);
+        }
+    }
+
+    return check(status, "Copying attributes");
+}
+
+//-----------------------------------------------------------------------------------------
+//defines the dimensions and variables of the container after the layout of source.
+// The time dimension becomes the record dimension; fields are stored as float.
+static bool defineContainer(int source, int output, int level, size_t chunkValues,
+                            std::vector<variablePlan> &plans, int &timeIndexID)
+{
+    int ndims = 0;
+    int timeDim = -1;
+    if(!check(nc_inq_ndims(source, &ndims), "Reading dimensions")
+            || !check(nc_inq_unlimdim(source, &timeDim), "Reading dimensions"))
+    {
+        return false;
+    }
+
+    //without a record dimension, time is whatever TIME is defined on
+    int timeID = 0;
+    if(timeDim < 0 && nc_inq_varid(source, "TIME", &timeID) == NC_NOERR)
+    {
+        int timeDims = 0;
+        nc_inq_varndims(source, timeID, &timeDims);
+        if(timeDims == 1)
+        {
+            nc_inq_vardimid(source, timeID, &timeDim);
+        }
+    }
+
+    if(timeDim < 0)
+    {
+        std::cerr << "Cannot find the time dimension." << std::endl;
+        return false;
+    }
+
+    //same dimensions in the same order, so the dimension IDs match the source
+    for(int d = 0; d < ndims; d++)
+    {
+        char name[NC_MAX_NAME+1];
+        size_t length = 0;
+        int dimID = 0;
+
+        if(!check(nc_inq_dimname(source, d, name), "Reading dimensions")
+                || !check(nc_inq_dimlen(source, d, &length), "Reading dimensions")
+                || !check(nc_def_dim(output, name, (d == timeDim) ? NC_UNLIMITED : length, &dimID), name))
+        {
+            return false;
+        }
+    }
+
+    if(!copyAttributes(source, NC_GLOBAL, output, NC_GLOBAL, false)
+            || !check(nc_put_att_text(output, NC_GLOBAL, CONTAINER::Attribute,
+                                      strlen(CONTAINER::Version), CONTAINER::Version), CONTAINER::Attribute))
+    {
+        return false;
+    }
+
+    int nvars = 0;
+    if(!check(nc_inq_nvars(source, &nvars), "Reading variables"))
+    {
+        return false;
+    }
+
+    for(int v = 0; v < nvars; v++)
+    {
+        char name[NC_MAX_NAME+1];
+        int varDims = 0;
+        int dimIDs[NC_MAX_VAR_DIMS];
+
+        variablePlan plan;
+        if(!check(nc_inq_varname(source, v, name), "Reading variables")
+                || !check(nc_inq_vartype(source, v, &plan.type), name)
+                || !check(nc_inq_varndims(source, v, &varDims), name)
+                || !check(nc_inq_vardimid(source, v, dimIDs), name))
+        {
+            return false;
+        }
+
+        plan.name = name;
+        plan.isRecord = (varDims > 0 && dimIDs[0] == timeDim);
+        plan.isField = plan.isRecord && varDims == 4
+                && (plan.type == NC_FLOAT || plan.type == NC_DOUBLE);
+        plan.chunkPlanes = 1;
+
+        for(int d = plan.isRecord ? 1 : 0; d < varDims; d++)
+        {
+            size_t length = 0;
+            nc_inq_dimlen(source, dimIDs[d], &length);
+            plan.shape.push_back(length);
+        }
+
+        nc_type outputType = plan.isField ? NC_FLOAT : plan.type;
+        if(!check(nc_def_var(output, name, outputType, varDims, dimIDs, &plan.outputID), name))
+        {
+            return false;
+        }
+
+        //one record per chunk in time, fields are cut up further
+        if(plan.isRecord)
+        {
+            std::vector<size_t> chunks(1, 1);
+            if(plan.isField)
+            {
+                size_t fieldChunks[3];
+                chooseChunks(&plan.shape[0], chunkValues, fieldChunks);
+                chunks.insert(chunks.end(), fieldChunks, fieldChunks+3);
+                plan.chunkPlanes = fieldChunks[0];
+            }
+            else
+            {
+                for(size_t d = 0; d < plan.shape.size(); d++)
+                {
+                    chunks.push_back(std::max<size_t>(plan.shape[d], 1));
+                }
+            }
+
+            if(!check(nc_def_var_chunking(output, plan.outputID, NC_CHUNKED, &chunks[0]), name))
+            {
+                return false;
+            }
+        }
+
+        if(varDims > 0 && level > 0
+                && !check(nc_def_var_deflate(output, plan.outputID, 1, 1, level), name))
+        {
+            return false;
+        }
+
+        if(!copyAttributes(source, v, output, plan.outputID, plan.isField))
+        {
+            return false;
+        }
+
+        plans.push_back(plan);
+    }
+
+    //the time index
+    static const char* longName = "Modified Julian Date of the time step";
+    static const char* units = "days since 1858-11-17 00:00:00";
+
+    if(!check(nc_def_var(output, CONTAINER::TimeIndex, NC_DOUBLE, 1, &timeDim, &timeIndexID), CONTAINER::TimeIndex)
+            || !check(nc_put_att_text(output, timeIndexID, "long_name", strlen(longName), longName), CONTAINER::TimeIndex)
+            || !check(nc_put_att_text(output, timeIndexID, "units", strlen(units), units), CONTAINER::TimeIndex))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------
+//copies the first record of every record variable of the file input into record
+// (or, with record < 0, every variable without a time dimension).
+static bool copyVariables(int input, const std::string &fileName, int output, int record,
+                          const std::vector<variablePlan> &plans)
+{
+    for(size_t p = 0; p < plans.size(); p++)
+    {
+        const variablePlan &plan = plans[p];
+        if(plan.isRecord != (record >= 0))
+        {
+            continue;
+        }
+
+        //every file of the series has to have the layout of the first one
+        int varID = 0;
+        int varDims = 0;
+        int dimIDs[NC_MAX_VAR_DIMS];
+        nc_type type;
+
+        bool matches = nc_inq_varid(input, plan.name.c_str(), &varID) == NC_NOERR
+                && nc_inq_vartype(input, varID, &type) == NC_NOERR
+                && nc_inq_varndims(input, varID, &varDims) == NC_NOERR
+                && nc_inq_vardimid(input, varID, dimIDs) == NC_NOERR
+                && (size_t)varDims == plan.shape.size() + (plan.isRecord ? 1 : 0)
+                && (type == plan.type || (plan.isField && (type == NC_FLOAT || type == NC_DOUBLE)));
+
+        const int first = plan.isRecord ? 1 : 0;
+        for(int d = first; matches && d < varDims; d++)
+        {
+            size_t length = 0;
+            matches = nc_inq_dimlen(input, dimIDs[d], &length) == NC_NOERR && length == plan.shape[d-first];
+        }
+
+        if(!matches)
+        {
+            std::cerr << fileName << ": " << plan.name << " does not match the first file of the series." << std::endl;
+            return false;
+        }
+
+        //(scalars still get one element, to have something to point to)
+        std::vector<size_t> readStart(std::max(varDims, 1), 0);
+        std::vector<size_t> readCount(std::max(varDims, 1), 1);
+        std::vector<size_t> writeStart(std::max(varDims, 1), 0);
+
+        for(int d = first; d < varDims; d++)
+        {
+            readCount[d] = plan.shape[d-first];
+        }
+        if(plan.isRecord)
+        {
+            writeStart[0] = record;
+        }
+
+        int status = NC_NOERR;
+
+        if(plan.isField)
+        {
+            //a chunk row of phi planes at a time, converted to float by the library
+            const size_t planeSize = plan.shape[1]*plan.shape[2];
+            std::vector<float> buffer(plan.chunkPlanes*planeSize);
+
+            for(size_t phi = 0; status == NC_NOERR && phi < plan.shape[0]; phi += plan.chunkPlanes)
+            {
+                readStart[1] = writeStart[1] = phi;
+                readCount[1] = std::min(plan.chunkPlanes, plan.shape[0]-phi);
+
+                status = nc_get_vara_float(input, varID, &readStart[0], &readCount[0], &buffer[0]);
+                if(status == NC_NOERR)
+                {
+                    status = nc_put_vara_float(output, plan.outputID, &writeStart[0], &readCount[0], &buffer[0]);
+                }
+            }
+        }
+        else
+        {
+            size_t count = typeSize(plan.type);
+            for(size_t d = 0; d < plan.shape.size(); d++)
+            {
+                count *= plan.shape[d];
+            }
+
+            std::vector<char> buffer(std::max<size_t>(count, 1));
+
+            status = nc_get_vara(input, varID, &readStart[0], &readCount[0], &buffer[0]);
+            if(status == NC_NOERR)
+            {
+                status = nc_put_vara(output, plan.outputID, &writeStart[0], &readCount[0], &buffer[0]);
+            }
+        }
+
+        if(!check(status, fileName + ": " + plan.name))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------
+static void usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [-d level] [-c values] output.nc input.nc [input.nc ...]" << std::endl
+              << "  -d level   deflate level 0-9 (default " << ENLIL_DEFLATE_LEVEL << ", 0 = no compression)" << std::endl
+              << "  -c values  maximum number of values in a chunk of a field (default " << ENLIL_CHUNK_VALUES << ")" << std::endl;
+}
+
+//=========================================================================================
+int main(int argc, char* argv[])
+{
+    int level = ENLIL_DEFLATE_LEVEL;
+    size_t chunkValues = ENLIL_CHUNK_VALUES;
+
+    int arg = 1;
+    for(; arg < argc-1 && argv[arg][0] == '-'; arg += 2)
+    {
+        if(strcmp(argv[arg], "-d") == 0)
+        {
+            level = std::max(0, std::min(9, atoi(argv[arg+1])));
+        }
+        else if(strcmp(argv[arg], "-c") == 0)
+        {
+            chunkValues = std::max(1L, atol(argv[arg+1]));
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(argc-arg < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string outputName = argv[arg++];
+
+    //find the time of every file and put them in order
+    std::vector<inputFile> inputs;
+    for(; arg < argc; arg++)
+    {
+        inputFile input;
+        input.fileName = argv[arg];
+
+        if(!readFileTime(input.fileName, input.mjd))
+        {
+            std::cerr << "Could not read the time from " << input.fileName << ", skipping it." << std::endl;
+            continue;
+        }
+
+        inputs.push_back(input);
+    }
+
+    std::stable_sort(inputs.begin(), inputs.end(), earlier);
+
+    //the reader keys time steps by their time, so a time can only be used once
+    for(size_t x = 1; x < inputs.size(); x++)
+    {
+        if(inputs[x].mjd == inputs[x-1].mjd)
+        {
+            std::cerr << inputs[x].fileName << " has the same time as " << inputs[x-1].fileName << ", skipping it." << std::endl;
+            inputs.erase(inputs.begin()+x);
+            x--;
+        }
+    }
+
+    if(inputs.empty())
+    {
+        std::cerr << "No readable ENLIL files." << std::endl;
+        return 1;
+    }
+
+    //the earliest file defines the layout of the container
+    int source = 0;
+    if(!check(nc_open(inputs[0].fileName.c_str(), NC_NOWRITE, &source), inputs[0].fileName))
+    {
+        return 1;
+    }
+
+    int output = 0;
+    if(!check(nc_create(outputName.c_str(), NC_CLOBBER | NC_NETCDF4 | NC_CLASSIC_MODEL, &output), outputName))
+    {
+        nc_close(source);
+        return 1;
+    }
+
+    std::vector<variablePlan> plans;
+    int timeIndexID = 0;
+
+    bool ok = defineContainer(source, output, level, chunkValues, plans, timeIndexID)
+            && check(nc_enddef(output), outputName)
+            && copyVariables(source, inputs[0].fileName, output, -1, plans);
+
+    nc_close(source);
+
+    //one record per file
+    for(size_t x = 0; ok && x < inputs.size(); x++)
+    {
+        std::cout << "[" << x+1 << "/" << inputs.size() << "] " << inputs[x].fileName << std::endl;
+
+        int input = 0;
+        ok = check(nc_open(inputs[x].fileName.c_str(), NC_NOWRITE, &input), inputs[x].fileName);
+        if(!ok)
+        {
+            break;
+        }
+
+        ok = copyVariables(input, inputs[x].fileName, output, (int)x, plans);
+        nc_close(input);
+    }
+
+    //the time index
+    if(ok)
+    {
+        std::vector<double> mjd(inputs.size());
+        for(size_t x = 0; x < inputs.size(); x++)
+        {
+            mjd[x] = inputs[x].mjd;
+        }
+
+        size_t start = 0;
+        size_t count = mjd.size();
+        ok = check(nc_put_vara_double(output, timeIndexID, &start, &count, &mjd[0]), CONTAINER::TimeIndex);
+    }
+
+    ok = check(nc_close(output), outputName) && ok;
+
+    if(!ok)
+    {
+        std::cerr << "Conversion failed, removing " << outputName << std::endl;
+        remove(outputName.c_str());
+        return 1;
+    }
+
+    std::cout << "Wrote " << inputs.size() << " time steps to " << outputName << std::endl;
+    return 0;
+}
@@ -1,10 +1,180 @@
 #include "readerCache.h"
 
+#include <string.h>
+#include <algorithm>
+
+//=========================================================================================
+RCache::cacheBudget::cacheBudget()
+{
+    this->maxSize = 0;
+    this->usage = 0;
+    this->compressedUsage = 0;
+    this->compressedShare = 0;
+    this->clock = 0;
+}
+
+//=========================================================================================
+RCache::cacheBudget::~cacheBudget()
+{
+    //caches are owned elsewhere, just forget about them
+    this->caches.clear();
+}
+
+//=========================================================================================
+void RCache::cacheBudget::setMaximumSize(double bytes)
+{
+    this->maxSize = (bytes > 0) ? bytes : 0;
+
+    //shrink to the new size if needed
+    this->evictTo(this->maxSize);
+    this->trimCompressed();
+}
+
+//=========================================================================================
+void RCache::cacheBudget::setCompressedShare(double share)
+{
+    this->compressedShare = std::max(0.0, std::min(share, 0.9));
+
+    //drops everything compressed when compression is turned off
+    this->trimCompressed();
+}
+
+//=========================================================================================
+void RCache::cacheBudget::registerCache(RCache::ReaderCache *cache)
+{
+    if(!this->caches.contains(cache))
+    {
+        this->caches.append(cache);
+    }
+}
+
+//=========================================================================================
+void RCache::cacheBudget::unregisterCache(RCache::ReaderCache *cache)
+{
+    this->caches.removeAll(cache);
+}
+
+//=========================================================================================
+bool RCache::cacheBudget::reserve(double bytes)
+{
+    //will never fit, so don't throw away what we have
+    if(bytes > this->maxSize)
+    {
+        return false;
+    }
+
+    //make room and account for the new element
+    this->evictTo(this->maxSize - bytes);
+    this->usage += bytes;
+
+    return true;
+}
+
+//=========================================================================================
+void RCache::cacheBudget::release(double bytes, bool compressed)
+{
+    this->usage -= bytes;
+
+    if(this->usage < 0)
+    {
+        this->usage = 0;
+    }
+
+    if(compressed)
+    {
+        this->compressedUsage -= bytes;
+
+        if(this->compressedUsage < 0)
+        {
+            this->compressedUsage = 0;
+        }
+    }
+}
+
+//=========================================================================================
+void RCache::cacheBudget::compressed(double raw, double packed)
+{
+    this->usage -= raw - packed;
+    this->compressedUsage += packed;
+}
+
+//=========================================================================================
+RCache::ReaderCache *RCache::cacheBudget::getOldestCache(bool compressed)
+{
+    RCache::ReaderCache* oldestCache = NULL;
+    unsigned long oldestAccess = 0;
+
+    for(int x = 0; x < this->caches.size(); x++)
+    {
+        unsigned long access = this->caches[x]->getOldestAccess(compressed);
+        if(access != 0 && (oldestCache == NULL || access < oldestAccess))
+        {
+            oldestCache = this->caches[x];
+            oldestAccess = access;
+        }
+    }
+
+    return oldestCache;
+}
+
+//=========================================================================================
+void RCache::cacheBudget::evictTo(double limit)
+{
+    while(this->usage > limit)
+    {
+        //find the caches holding the least recently used raw and compressed elements
+        RCache::ReaderCache* oldestRaw = this->getOldestCache(false);
+        RCache::ReaderCache* oldestCompressed = this->getOldestCache(true);
+
+        //nothing left to evict
+        if(oldestRaw == NULL && oldestCompressed == NULL)
+        {
+            this->usage = 0;
+            this->compressedUsage = 0;
+            break;
+        }
+
+        //every step removes a raw or a compressed element, and the
+        // compress/evict calls release the memory back to us
+        if(oldestRaw != NULL && this->compressedShare > 0)
+        {
+            oldestRaw->compressOldest();
+            this->trimCompressed();
+        }
+        else if(oldestRaw != NULL)
+        {
+            oldestRaw->evictOldest(false);
+        }
+        else
+        {
+            oldestCompressed->evictOldest(true);
+        }
+    }
+}
+
+//=========================================================================================
+void RCache::cacheBudget::trimCompressed()
+{
+    while(this->compressedUsage > this->compressedShare*this->maxSize)
+    {
+        RCache::ReaderCache* oldestCompressed = this->getOldestCache(true);
+
+        if(oldestCompressed == NULL)
+        {
+            this->compressedUsage = 0;
+            break;
+        }
+
+        oldestCompressed->evictOldest(true);
+    }
+}
+
 //=========================================================================================
 RCache::ReaderCache::ReaderCache()
 {
     this->dirty = false;
-
+    this->budget = NULL;
+    this->clock = 0;
 }
 
 //=========================================================================================
@@ -12,9 +182,32 @@ RCache::ReaderCache::~ReaderCache()
 {
     if(this->cache.size() > 0)
     {
-        std::cout << __FUNCTION__ << " Reader Cache Destructor... "  << std::flush << std::endl;
         this->cleanCache();
     }
+
+    if(this->budget)
+    {
+        this->budget->unregisterCache(this);
+    }
+}
+
+//=========================================================================================
+void RCache::ReaderCache::setBudget(RCache::cacheBudget *budget)
+{
+    //elements were accounted for in the old budget
+    this->cleanCache();
+
+    if(this->budget)
+    {
+        this->budget->unregisterCache(this);
+    }
+
+    this->budget = budget;
+
+    if(this->budget)
+    {
+        this->budget->registerCache(this);
+    }
 }
 
 //=========================================================================================
@@ -31,31 +224,43 @@ void RCache::ReaderCache::addCacheElement( double time,  RCache::extents xtents,
 {
     //if the time doesn't exist, we are going to add it anyway, so lets just do it.
 
-    std::cout << __FUNCTION__ << std::endl;
+    if(array == NULL)
+    {
+        return;
+    }
+
+    //already there, so just mark it as recently used
+    if(this->isInCache(time, xtents))
+    {
+        this->promoteElement(time, xtents);
+        return;
+    }
+
+    //GetActualMemorySize() reports kibibytes
+    double size = array->GetActualMemorySize() * 1024.0;
+
+    //make room for the element.  If it can never fit, don't cache it.
+    if(this->budget && !this->budget->reserve(size))
+    {
+        return;
+    }
 
     //create the element if time not available
     if(!this->cache.contains(time))
     {
-        std::cout << "Adding Time Level... " << std::endl;
         addTimeLevel(time);
     }
 
     //add the element
-    std::cout << "Reference Count Prior to add: " << array->GetReferenceCount() << std::endl;
-    cacheMap* currentMap = &this->cache[time];
-    currentMap->addCacheElement(xtents, array);
-    std::cout << "Reference Count After Add: " << array->GetReferenceCount() << std::endl;
-    std::cout << "Map Size: " << currentMap->getNumberElments() << std::endl;
+    unsigned long stamp = (this->budget) ? this->budget->touch() : ++this->clock;
 
+    cacheMap* currentMap = &this->cache[time];
+    currentMap->addCacheElement(xtents, array, stamp, size);
 }
 
 //=========================================================================================
 RCache::cacheElement *RCache::ReaderCache::getExtentsFromCache(double time, RCache::extents xtents)
 {
-
-    std::map<double,cacheMap>::iterator timeElement;
-
-
     //this must be NULL to start with or algorithm won't work
     RCache::cacheElement *currentArray = NULL;
 
@@ -66,6 +271,40 @@ RCache::cacheElement *RCache::ReaderCache::getExtentsFromCache(double time, RCac
         //the time segment is actually in the cache
         cacheMap* currentMap = &this->cache[time];
 
+        //exact match first
+        currentArray = currentMap->getCacheElement(xtents);
+
+        //compressed elements move back to the raw tier when used
+        if(currentArray && currentArray->isCompressed())
+        {
+            currentArray = this->decompressElement(time, xtents);
+
+            if(currentArray == NULL && !this->cache.contains(time))
+            {
+                return NULL;
+            }
+        }
+
+        if(currentArray == NULL)
+        {
+            //see if we have a superset of the requested extents
+            RCache::cacheElement* superset = this->cache[time].getCacheElementContains(xtents);
+
+            if(superset && superset->isCompressed())
+            {
+                superset = this->decompressElement(time, superset->xtents);
+            }
+
+            if(superset && RCache::ReaderCache::extractFromArray(xtents, superset, &this->extracted))
+            {
+                superset->lastAccess = (this->budget) ? this->budget->touch() : ++this->clock;
+                currentArray = &this->extracted;
+            }
+        }
+        else
+        {
+            currentArray->lastAccess = (this->budget) ? this->budget->touch() : ++this->clock;
+        }
     }
 
 
@@ -82,138 +321,299 @@ void RCache::ReaderCache::cleanCache()
     //kill the cache map
     if(this->cache.size() > 0)
     {
-        std::cout << __FUNCTION__ << " Killing Entire Map... " <<  std::flush << std::endl;
+        if(this->budget)
+        {
+            double compressedUsage = 0;
+
+            QMap<double, cacheMap>::Iterator iter;
+            for(iter = this->cache.begin(); iter != this->cache.end(); ++iter)
+            {
+                compressedUsage += iter.value().getCompressedUsage();
+            }
+
+            this->budget->release(this->getCacheUsage() - compressedUsage);
+            this->budget->release(compressedUsage, true);
+        }
+
         this->cache.clear();
     }
+
+    this->extracted.data = NULL;
 }
 
 //=========================================================================================
-RCache::cacheElement *RCache::ReaderCache::extractFromArray(RCache::extents xtents,  RCache::cacheElement *cacheArray)
-{
-    //    if(cacheArray->data->GetDataType() == VTK_FLOAT)
-    //    {
-    //        //cast to float array and call float function
-    //        vtkFloatArray* current = vtkFloatArray::SafeDownCast(cacheArray->data);
-    //        return RCache::ReaderCache::extractFromArray(xtents, cacheArray->xtents, current);
-    //    }
-    //    else if(cacheArray->data->GetDataType() == VTK_DOUBLE)
-    //    {
-    //        //cast to double array and call function
-    //        vtkDoubleArray* current = vtkDoubleArray::SafeDownCast(cacheArray->data);
-    //        return RCache::ReaderCache::extractFromArray(xtents, cacheArray->xtents, current);
-    //    }
-    //    else if(cacheArray->data->GetDataType() == VTK_INT)
-    //    {
-    //        //cast to int array and call function
-    //        vtkIntArray* current = vtkIntArray::SafeDownCast(cacheArray->data);
-    //        return RCache::ReaderCache::extractFromArray(xtents, cacheArray->xtents, current);
-    //    }
-    //    else
-    //    {
-    return NULL;
-    //    }
+unsigned long RCache::ReaderCache::getOldestAccess(bool compressed)
+{
+    unsigned long oldest = 0;
+
+    QMap<double, cacheMap>::Iterator iter;
+    for(iter = this->cache.begin(); iter != this->cache.end(); ++iter)
+    {
+        RCache::cacheElement* element = iter.value().getOldestElement(compressed);
+        if(element && (oldest == 0 || element->lastAccess < oldest))
+        {
+            oldest = element->lastAccess;
+        }
+    }
+
+    return oldest;
 }
 
-RCache::cacheElement *RCache::ReaderCache::extractFromArray(RCache::extents newXtetnts, RCache::extents oldXtents,  vtkDoubleArray *cacheArray)
+//=========================================================================================
+double RCache::ReaderCache::evictOldest(bool compressed)
 {
-    //extract the proper extents and put in new object
-    //    RCache::cacheElement *newElement = new cacheElement;
-    //    newElement->data = vtkDoubleArray::New();
+    QMap<double, cacheMap>::Iterator iter;
+    QMap<double, cacheMap>::Iterator oldestIter = this->cache.end();
+    RCache::cacheElement* oldest = NULL;
+
+    for(iter = this->cache.begin(); iter != this->cache.end(); ++iter)
+    {
+        RCache::cacheElement* element = iter.value().getOldestElement(compressed);
+        if(element && (oldest == NULL || element->lastAccess < oldest->lastAccess))
+        {
+            oldest = element;
+            oldestIter = iter;
+        }
+    }
 
-    abort();
+    if(oldest == NULL)
+    {
+        return 0;
+    }
 
-    return NULL;
+    double released = oldestIter.value().removeCacheElement(oldest->xtents);
+
+    //drop the time level once it is empty
+    if(oldestIter.value().getNumberElments() == 0)
+    {
+        this->cache.erase(oldestIter);
+    }
+
+    if(this->budget)
+    {
+        this->budget->release(released, compressed);
+    }
 
+    return released;
 }
 
-RCache::cacheElement *RCache::ReaderCache::extractFromArray(RCache::extents newXtetnts, RCache::extents oldXtents, vtkFloatArray *cacheArray)
+//=========================================================================================
+void RCache::ReaderCache::compressOldest()
 {
-    //extract the proper extents and put in new object
-    //    RCache::cacheElement *newElement = new cacheElement;
-    //    newElement->data = vtkFloatArray::New();
+    QMap<double, cacheMap>::Iterator iter;
+    QMap<double, cacheMap>::Iterator oldestIter = this->cache.end();
+    RCache::cacheElement* oldest = NULL;
+
+    for(iter = this->cache.begin(); iter != this->cache.end(); ++iter)
+    {
+        RCache::cacheElement* element = iter.value().getOldestElement(false);
+        if(element && (oldest == NULL || element->lastAccess < oldest->lastAccess))
+        {
+            oldest = element;
+            oldestIter = iter;
+        }
+    }
 
-    abort();
+    if(oldest == NULL)
+    {
+        return;
+    }
 
-    return NULL;
+    //arrays that don't shrink by at least a fifth aren't worth the time to inflate
+    QSharedPointer<readerCompressedArray> compressed(new readerCompressedArray);
+    if(!compressed->compress(oldest->data) || compressed->getSize() > 0.8*oldest->size)
+    {
+        this->evictOldest(false);
+        return;
+    }
+
+    double raw = oldest->size;
+    oldestIter.value().setCompressed(oldest->xtents, compressed);
+
+    if(this->budget)
+    {
+        this->budget->compressed(raw, compressed->getSize());
+    }
 }
 
-RCache::cacheElement *RCache::ReaderCache::extractFromArray(RCache::extents newXtetnts, RCache::extents oldXtents,  vtkIntArray *cacheArray)
+//=========================================================================================
+RCache::cacheElement *RCache::ReaderCache::decompressElement(double time, RCache::extents xtents)
 {
-    //extract the proper extents and put in new object
-    //    RCache::cacheElement *newElement = new cacheElement;
-    //    newElement->data = vtkIntArray::New();
+    if(!this->cache.contains(time))
+    {
+        return NULL;
+    }
+
+    RCache::cacheElement* element = this->cache[time].getCacheElement(xtents);
+    if(element == NULL || !element->isCompressed())
+    {
+        return element;
+    }
 
-    abort();
+    vtkAbstractArray* array = element->compressed->decompress();
 
-    return NULL;
+    //take the element out of the compressed tier, and add it back as a raw array.
+    // Making room for it may compress or drop other elements.
+    double released = this->cache[time].removeCacheElement(xtents);
+    if(this->budget)
+    {
+        this->budget->release(released, true);
+    }
+
+    if(array == NULL)
+    {
+        return NULL;
+    }
+
+    this->addCacheElement(time, xtents, array);
+
+    element = (this->cache.contains(time)) ? this->cache[time].getCacheElement(xtents) : NULL;
+    if(element == NULL)
+    {
+        //too big to cache any more, hand it out once
+        this->extracted.xtents = xtents;
+        this->extracted.data = array;
+        this->extracted.initd = true;
+        this->extracted.lastAccess = 0;
+        this->extracted.size = array->GetActualMemorySize() * 1024.0;
+        element = &this->extracted;
+    }
+
+    //the cache (or the extracted holder) now holds the reference
+    array->Delete();
+
+    return element;
 }
 
 //=========================================================================================
-bool RCache::ReaderCache::isInCache(double time, RCache::extents xtents)
+double RCache::ReaderCache::getCacheUsage()
 {
-    std::map<double,cacheMap>::iterator timeElement;
-    cacheMap* currentMap=NULL;
+    double usage = 0;
 
-    if(this->cache.contains(time))
+    QMap<double, cacheMap>::Iterator iter;
+    for(iter = this->cache.begin(); iter != this->cache.end(); ++iter)
     {
-        currentMap = &this->cache[time];
-        if(currentMap->hasCacheElement(xtents))
-        {
-            return true;
-        }
+        usage += iter.value().getCacheUsage();
     }
 
-    return false;
-
+    return usage;
 }
 
 //=========================================================================================
-void RCache::ReaderCache::pruneTimeFromEndTo(double time)
+bool RCache::ReaderCache::extractFromArray(RCache::extents xtents,  RCache::cacheElement *cacheArray, RCache::cacheElement *result)
 {
+    if(cacheArray == NULL || result == NULL || !cacheArray->xtents.contains(xtents))
+    {
+        return false;
+    }
+
+    vtkAbstractArray* subArray = RCache::ReaderCache::extractFromArray(xtents, cacheArray->xtents, cacheArray->data);
+
+    if(subArray == NULL)
+    {
+        return false;
+    }
+
+    result->xtents = xtents;
+    result->data = subArray;
+    result->initd = true;
+    result->lastAccess = cacheArray->lastAccess;
+    result->size = subArray->GetActualMemorySize() * 1024.0;
+
+    //the smart pointer now holds the reference
+    subArray->Delete();
+
+    return true;
 }
 
 //=========================================================================================
-void RCache::ReaderCache::pruneExtentsFromTime(RCache::extents xtents)
+//returns a NEW array (caller must Delete()) holding newXtents copied out of cacheArray,
+// which is laid out over oldXtents (i fastest, k slowest)
+vtkAbstractArray *RCache::ReaderCache::extractFromArray(RCache::extents newXtents, RCache::extents oldXtents,  vtkAbstractArray *cacheArray)
 {
+    if(cacheArray == NULL || !oldXtents.contains(newXtents))
+    {
+        return NULL;
+    }
+
+    int oldExt[6];
+    int newExt[6];
+    oldXtents.getExtents(oldExt);
+    newXtents.getExtents(newExt);
+
+    //sizes of the cached array
+    vtkIdType oldDimI = oldExt[1] - oldExt[0] + 1;
+    vtkIdType oldDimJ = oldExt[3] - oldExt[2] + 1;
+
+    //sizes of the requested array
+    vtkIdType newDimI = newExt[1] - newExt[0] + 1;
+    vtkIdType newDimJ = newExt[3] - newExt[2] + 1;
+    vtkIdType newDimK = newExt[5] - newExt[4] + 1;
+
+    //the cached array must actually cover the cached extents
+    if(cacheArray->GetNumberOfTuples() != oldXtents.getNumberOfPoints())
+    {
+        return NULL;
+    }
+
+    vtkAbstractArray* newArray = cacheArray->NewInstance();
+    newArray->SetName(cacheArray->GetName());
+    newArray->SetNumberOfComponents(cacheArray->GetNumberOfComponents());
+    newArray->SetNumberOfTuples(newXtents.getNumberOfPoints());
+
+    //copy i-rows, which are contiguous in both arrays
+    size_t tupleSize = cacheArray->GetNumberOfComponents() * cacheArray->GetDataTypeSize();
+    size_t rowSize   = newDimI * tupleSize;
+
+    const char* source = static_cast<const char*>(cacheArray->GetVoidPointer(0));
+    char* destination  = static_cast<char*>(newArray->GetVoidPointer(0));
+
+    for(vtkIdType k = 0; k < newDimK; k++)
+    {
+        for(vtkIdType j = 0; j < newDimJ; j++)
+        {
+            vtkIdType oldLoc = ((k + newExt[4] - oldExt[4]) * oldDimJ + (j + newExt[2] - oldExt[2])) * oldDimI
+                    + (newExt[0] - oldExt[0]);
+
+            memcpy(destination, source + oldLoc*tupleSize, rowSize);
+            destination += rowSize;
+        }
+    }
+
+    return newArray;
 }
 
 //=========================================================================================
-void RCache::ReaderCache::promoteElement(double time, RCache::extents Xtents)
+bool RCache::ReaderCache::isInCache(double time, RCache::extents xtents)
 {
-    QStack<RCache::cacheElement*>*  currentStack;
-    RCache::cacheElement* currentElement;
+    cacheMap* currentMap=NULL;
 
-    QStack<RCache::cacheElement*>::Iterator itr;
+    if(this->cache.contains(time))
+    {
+        currentMap = &this->cache[time];
+        if(currentMap->hasCacheElement(xtents))
+        {
+            return true;
+        }
+    }
 
-    int count = 0;
+    return false;
 
-    //get the current stack for the current time
-    //  then promote the entry
-    //    if(this->cacheStack.contains(time))
-    //    {
-    //        currentStack = this->cacheStack[time];
+}
 
-    //        for(itr=currentStack->begin(); itr != currentStack->end(); ++itr)
-    //        {
-    //            currentElement = dynamic_cast<RCache::cacheElement*>(*itr);
-    //            if(currentElement->xtents == Xtents)
-    //            {
-    //                //remove and then insert at the top
-    //                if(itr != currentStack->begin())
-    //                {
-    //                    //remove elemnt
-    //                    currentStack->remove(count);
-    //                    //insert at the top
-    //                    currentStack->push(currentElement);
-    //                }
-    //                //don't go beyond the point we are looking for
-    //                break;
-    //            }
+//=========================================================================================
+void RCache::ReaderCache::promoteElement(double time, RCache::extents Xtents)
+{
+    //elements are ordered by access stamp, so promoting just updates the stamp
+    if(this->cache.contains(time))
+    {
+        RCache::cacheElement* currentElement = this->cache[time].getCacheElement(Xtents);
 
-    //            //for some reason, we don't have a remove() method for iterators
-    //          count++;
-    //        }
-    //    }
+        if(currentElement)
+        {
+            currentElement->lastAccess = (this->budget) ? this->budget->touch() : ++this->clock;
+        }
+    }
 }
 
 //=========================================================================================
@@ -226,6 +626,7 @@ RCache::extents::extents(int &x1, int &x2, int &x3, int &x4, int &x5, int &x6, b
     this->xtents[4] = x5;
     this->xtents[5] = x6;
 
+    this->stride = 1;
     this->persists = persists;
 }
 
@@ -238,6 +639,7 @@ RCache::extents::extents(const int *xtents, bool persists)
     this->xtents[4] = xtents[4];
     this->xtents[5] = xtents[5];
 
+    this->stride = 1;
     this->persists = persists;
 }
 
@@ -249,6 +651,7 @@ RCache::extents::extents()
     this->xtents[3] = 0;
     this->xtents[4] = 0;
     this->xtents[5] = 0;
+    this->stride = 1;
     this->persists = false;
 }
 
@@ -266,7 +669,8 @@ bool RCache::extents::operator==(const extents &rhs) const
             this->xtents[2] == rhs.xtents[2] &&
             this->xtents[3] == rhs.xtents[3] &&
             this->xtents[4] == rhs.xtents[4] &&
-            this->xtents[5] == rhs.xtents[5])
+            this->xtents[5] == rhs.xtents[5] &&
+            this->stride == rhs.stride)
     {
         return true;
     }
@@ -346,6 +750,32 @@ int *RCache::extents::getExtents()
     return returnval;
 }
 
+//=========================================================================================
+void RCache::extents::getExtents(int x[6]) const
+{
+    for(int i = 0; i < 6; i++)
+    {
+        x[i] = this->xtents[i];
+    }
+}
+
+//=========================================================================================
+bool RCache::extents::contains(const RCache::extents &rhs) const
+{
+    return (this->stride == rhs.stride &&
+            this->xtents[0] <= rhs.xtents[0] && rhs.xtents[1] <= this->xtents[1] &&
+            this->xtents[2] <= rhs.xtents[2] && rhs.xtents[3] <= this->xtents[3] &&
+            this->xtents[4] <= rhs.xtents[4] && rhs.xtents[5] <= this->xtents[5]);
+}
+
+//=========================================================================================
+vtkIdType RCache::extents::getNumberOfPoints() const
+{
+    return (vtkIdType)(this->xtents[1] - this->xtents[0] + 1)
+            * (this->xtents[3] - this->xtents[2] + 1)
+            * (this->xtents[5] - this->xtents[4] + 1);
+}
+
 //=========================================================================================
 void RCache::extents::setPersistance(bool persists)
 {
@@ -357,49 +787,40 @@ RCache::cacheMap::cacheMap()
 {
     //initalize cache size counter
     this->cacheSize = 0;
+    this->compressedSize = 0;
     this->initd = false;
 }
 
 RCache::cacheMap::~cacheMap()
 {
     //need to delete all of the vtkAbstractArrays
-    std::cout << __FUNCTION__ << std::endl;
     this->clearCacheMap();
 }
 
 //=========================================================================================
-void RCache::cacheMap::addCacheElement(RCache::extents xtents, vtkAbstractArray *data)
+void RCache::cacheMap::addCacheElement(RCache::extents xtents, vtkAbstractArray *data, unsigned long stamp, double size)
 {  
     //check to see if element is already in the stack
-    QList<RCache::cacheElement>::Iterator iter;
-
-    //temp pointer for promoting item on stack
-    RCache::cacheElement* tempEl = NULL;
-
-    //index
-    int index = 0;
-
-    for(index = 0; index < this->cacheStack.size(); index++)
+    for(int index = 0; index < this->cacheStack.size(); index++)
     {
         if(this->cacheStack[index].xtents == xtents)
         {
-            std::cout << "Found Existing Element ... promoting" << std::endl;
-
-            //delete from current position and place on top of stack
-            //this->cacheStack.move(index, 0);
-
+            //already here... just mark it as used
+            this->cacheStack[index].lastAccess = stamp;
             return;
         }
     }
 
-
-    std::cout << "ADDING NEW ELEMENT" << std::endl;
     RCache::cacheElement newElement;
     newElement.xtents = xtents;
     newElement.data = data;
+    newElement.initd = true;
+    newElement.lastAccess = stamp;
+    newElement.size = size;
 
     //add to the stack
     this->cacheStack.prepend(newElement);
+    this->cacheSize += size;
 
 }
 
@@ -415,11 +836,9 @@ RCache::cacheElement *RCache::cacheMap::getCacheElement(RCache::extents xtents)
         tempEl = &*iter;
         if(tempEl->xtents == xtents)
         {
-            std::cout << "Element Found ... Returning" << std::endl;
             return tempEl;
         }
     }
-    std::cout << "Element NOT found" << std::endl;
 
     return NULL;
 }
@@ -445,20 +864,79 @@ bool RCache::cacheMap::hasCacheElement(RCache::extents xtents)
 }
 
 //=========================================================================================
+//returns the smallest cached element whose extents contain the requested extents
 RCache::cacheElement *RCache::cacheMap::getCacheElementContains(RCache::extents xtents)
 {
+    QList<RCache::cacheElement>::Iterator iter;
+    RCache::cacheElement* tempEl = NULL;
+    RCache::cacheElement* bestEl = NULL;
 
-    abort();
+    for(iter = this->cacheStack.begin(); iter != this->cacheStack.end(); ++iter)
+    {
+        tempEl = &*iter;
+        if(tempEl->xtents.contains(xtents))
+        {
+            if(bestEl == NULL || tempEl->xtents.getNumberOfPoints() < bestEl->xtents.getNumberOfPoints())
+            {
+                bestEl = tempEl;
+            }
+        }
+    }
 
-    return NULL;
+    return bestEl;
 }
 
 //=========================================================================================
-void RCache::cacheMap::removeCacheElement(RCache::extents xtents)
+RCache::cacheElement *RCache::cacheMap::getOldestElement(bool compressed)
+{
+    QList<RCache::cacheElement>::Iterator iter;
+    RCache::cacheElement* tempEl = NULL;
+    RCache::cacheElement* oldestEl = NULL;
+
+    for(iter = this->cacheStack.begin(); iter != this->cacheStack.end(); ++iter)
+    {
+        tempEl = &*iter;
+        if(tempEl->isCompressed() != compressed)
+        {
+            continue;
+        }
+
+        if(oldestEl == NULL || tempEl->lastAccess < oldestEl->lastAccess)
+        {
+            oldestEl = tempEl;
+        }
+    }
+
+    return oldestEl;
+}
+
+//=========================================================================================
+void RCache::cacheMap::setCompressed(RCache::extents xtents, QSharedPointer<readerCompressedArray> compressed)
+{
+    RCache::cacheElement* element = this->getCacheElement(xtents);
+
+    if(element == NULL || element->isCompressed() || compressed.isNull())
+    {
+        return;
+    }
+
+    double packed = compressed->getSize();
+
+    this->cacheSize += packed - element->size;
+    this->compressedSize += packed;
+
+    element->data = NULL;
+    element->compressed = compressed;
+    element->size = packed;
+}
+
+//=========================================================================================
+double RCache::cacheMap::removeCacheElement(RCache::extents xtents)
 {
 
     QList<RCache::cacheElement>::Iterator iter;
     RCache::cacheElement* tempEl = NULL;
+    double released = 0;
 
     for(iter = this->cacheStack.begin(); iter != this->cacheStack.end(); ++iter)
     {
@@ -466,6 +944,13 @@ void RCache::cacheMap::removeCacheElement(RCache::extents xtents)
         if(tempEl->xtents == xtents)
         {
             //found it... so remove it...
+            released = tempEl->size;
+            this->cacheSize -= released;
+
+            if(tempEl->isCompressed())
+            {
+                this->compressedSize -= released;
+            }
             this->cacheStack.erase(iter);
 
             //our loop is no longer valid, so kill it
@@ -473,7 +958,7 @@ void RCache::cacheMap::removeCacheElement(RCache::extents xtents)
         }
     }
 
-
+    return released;
 }
 
 //=========================================================================================
@@ -481,8 +966,9 @@ void RCache::cacheMap::clearCacheMap()
 {
     // since we are using vtkSmartPointer and we don't have to do much for
     // cleanup, except the following:
-    std::cout <<  __FUNCTION__ << " Clearing Cache... " << std::flush << std::endl;
     this->cacheStack.clear();
+    this->cacheSize = 0;
+    this->compressedSize = 0;
 
 }
 
@@ -490,7 +976,3 @@ int RCache::cacheMap::getNumberElments()
 {
     return this->cacheStack.size();
 }
-
-
-
-
@@ -5,6 +5,7 @@
 #include <vector>
 #include <QString>
 #include <QStack>
+#include <QSharedPointer>
 #include "vtkAbstractArray.h"
 #include "vtkFloatArray.h"
 #include "vtkDoubleArray.h"
@@ -12,6 +13,7 @@
 #include "vtkStringArray.h"
 #include "vtkSetGet.h"
 #include "vtkSmartPointer.h"
+#include "readerCompressedArray.h"
 
 
 #include <QMap>
@@ -29,6 +31,8 @@ class cacheMap;
 namespace RCache
 {
 
+class ReaderCache;
+
 //=========================================================================================
 //this is a helper class for keeping track of extents
 class extents
@@ -55,12 +59,27 @@ public:
     //gets all extents as an int array of 6 elements (int x[6])
     int* getExtents();
 
+    //copies all extents into a user supplied array (int x[6])
+    void getExtents(int x[6]) const;
+
+    //returns true if rhs lies completely within (or is equal to) this
+    bool contains(const extents &rhs) const;
+
+    //number of points covered by the extents
+    vtkIdType getNumberOfPoints() const;
+
     //set the persistance flag
     void setPersistance(bool persists);
 
+    //sampling stride of the extents (1 = full resolution).  Extents with different
+    // strides live in different index spaces, so they never match or contain each other.
+    void setStride(int stride) { this->stride = stride; }
+    int getStride() const { return this->stride; }
+
  protected:
     //the actual extents being kept track of
     int xtents[6];
+    int stride;
     bool persists;
 };
 
@@ -71,8 +90,10 @@ public:
     cacheElement()
     {
         this->initd = false;
+        this->lastAccess = 0;
+        this->size = 0;
         //nothing to do
-        std::cout << "Creating a Data Element... " << std::flush << std::endl;
+        //std::cout << "Creating a Data Element... " << std::flush << std::endl;
     }
 
     ~cacheElement()
@@ -84,6 +105,17 @@ public:
     vtkSmartPointer<vtkAbstractArray> data;
     bool initd;
 
+    //access stamp used for LRU eviction (larger is more recent)
+    unsigned long lastAccess;
+
+    //memory used by data, or by compressed when it is compressed (in bytes)
+    double size;
+
+    //set (and data NULL) while the element sits in the compressed tier
+    QSharedPointer<readerCompressedArray> compressed;
+
+    bool isCompressed() const { return !this->compressed.isNull(); }
+
 };
 
 
@@ -96,7 +128,7 @@ public:
     ~cacheMap();
 
     //adds a cache element to the maping if it doesn't already exist
-    void addCacheElement(extents xtents, vtkAbstractArray* data);
+    void addCacheElement(extents xtents, vtkAbstractArray* data, unsigned long stamp = 0, double size = 0);
 
     //returns the appropriate data segment from the cache
     cacheElement* getCacheElement(extents xtents);
@@ -108,8 +140,15 @@ public:
     //user must parse to get required elements
     cacheElement* getCacheElementContains(extents xtents);
 
+    //returns the least recently used raw (or compressed) element (NULL if none)
+    cacheElement* getOldestElement(bool compressed = false);
+
+    //moves an element into the compressed tier, releasing its array
+    void setCompressed(extents xtents, QSharedPointer<readerCompressedArray> compressed);
+
     //removes a specific element from the cache map
-    void removeCacheElement(extents xtents);
+    //returns the memory (in bytes) released
+    double removeCacheElement(extents xtents);
 
     //removes all elements from the cache map
     void clearCacheMap();
@@ -117,6 +156,9 @@ public:
     //return the amount of memory being used by cache
     double getCacheUsage() { return this->cacheSize; }
 
+    //part of getCacheUsage() held by compressed elements
+    double getCompressedUsage() { return this->compressedSize; }
+
     //initialize
     void initialize() {this->initd = true;}
 
@@ -130,13 +172,76 @@ protected:
     //I am switching over to a stack for the cache
     QList<RCache::cacheElement>  cacheStack;
 
-    //running total of memory usage
+    //running total of memory usage, and of the compressed elements in it
     double cacheSize;
+    double compressedSize;
 
     //flag for initalization
     bool initd;
 };
 
+//=========================================================================================
+//keeps track of memory used by a group of reader caches.  When a new element will not fit
+// in the budget, the least recently used element of all registered caches is evicted.
+// With a compressed share, evicted elements are compressed instead, and only dropped
+// once the compressed elements use more than that share of the budget.
+class cacheBudget
+{
+public:
+    cacheBudget();
+    ~cacheBudget();
+
+    //set the maximum amount of memory (in bytes) the registered caches may use
+    void setMaximumSize(double bytes);
+    double getMaximumSize() { return this->maxSize; }
+
+    //amount of memory currently held by the registered caches
+    double getCacheUsage() { return this->usage; }
+
+    //fraction (0-0.9) of the budget that compressed elements may use, 0 disables
+    // compression.  Shrinking it drops the least recently used compressed elements.
+    void setCompressedShare(double share);
+    double getCompressedShare() { return this->compressedShare; }
+
+    //part of getCacheUsage() held by compressed elements
+    double getCompressedUsage() { return this->compressedUsage; }
+
+    //add/remove caches that share this budget
+    void registerCache(ReaderCache* cache);
+    void unregisterCache(ReaderCache* cache);
+
+    //make room for an element of size bytes, evicting least recently used elements.
+    // returns false if the element can never fit in the budget.
+    bool reserve(double bytes);
+
+    //return memory to the budget
+    void release(double bytes, bool compressed = false);
+
+    //an element of raw bytes now takes packed bytes in the compressed tier
+    void compressed(double raw, double packed);
+
+    //returns a new access stamp
+    unsigned long touch() { return ++this->clock; }
+
+protected:
+    //evict elements until usage is at or below limit
+    void evictTo(double limit);
+
+    //drop compressed elements until they fit in their share
+    void trimCompressed();
+
+    //cache holding the least recently used raw (or compressed) element, NULL if none
+    RCache::ReaderCache* getOldestCache(bool compressed);
+
+    QList<RCache::ReaderCache*> caches;
+
+    double maxSize;
+    double usage;
+    double compressedUsage;
+    double compressedShare;
+    unsigned long clock;
+};
+
 //=========================================================================================
 //this is the actuall reader cache object
 class ReaderCache
@@ -145,12 +250,17 @@ public:
     ReaderCache();
     ~ReaderCache();
 
+    //share the memory budget (and LRU ordering) with other caches
+    void setBudget(cacheBudget* budget);
+
     //this will either cache the element or not
     //depending on wether the extents are in the cache already or not
     void addCacheElement(double time,  extents xtents,  vtkAbstractArray *array);
 
     //this will get the requested extents from the Cache, or return NULL if
-    // the extents are NOT in the cache
+    // the extents are NOT in the cache.  If only a superset of the extents is
+    // cached, the requested extents are sliced out of it in memory.
+    // The returned element is only valid until the next call.
     cacheElement *getExtentsFromCache(double time, extents xtents);
 
     //clean the cache when we need to dump it for something else
@@ -158,32 +268,52 @@ public:
 
     //build a new data array of proper type and
     // extract requested elements from cacheElement in map
-    //TODO: These need to be re-done so that it works solely with cacheElments
-    static RCache::cacheElement* extractFromArray(extents xtetnts,  RCache::cacheElement* cacheArray);
-    static RCache::cacheElement* extractFromArray(extents newXtetnts, extents oldXtents,  vtkDoubleArray* cacheArray);
-    static RCache::cacheElement* extractFromArray(extents newXtetnts, extents oldXtents,  vtkFloatArray* cacheArray);
-    static RCache::cacheElement* extractFromArray(extents newXtetnts, extents oldXtents,  vtkIntArray* cacheArray);
+    static bool extractFromArray(extents xtents,  RCache::cacheElement* cacheArray, RCache::cacheElement* result);
+    static vtkAbstractArray* extractFromArray(extents newXtents, extents oldXtents,  vtkAbstractArray* cacheArray);
 
     void addTimeLevel(double time);
+
+    //returns the access stamp of the least recently used raw (or compressed) element
+    // (0 if there is none)
+    unsigned long getOldestAccess(bool compressed = false);
+
+    //removes the least recently used raw (or compressed) element, returning the memory
+    // (in bytes) released
+    double evictOldest(bool compressed = false);
+
+    //moves the least recently used raw element to the compressed tier.  It is dropped
+    // instead if it does not compress well.
+    void compressOldest();
+
+    //amount of memory used by this cache (in bytes)
+    double getCacheUsage();
+
 protected:
 
     //will return true if extents are already in the cache
     bool isInCache(double time, extents xtents);
 
-    //will remove time steps from the cache
-    void pruneTimeFromEndTo(double time);
-
-    //will remove extents (if they are discrete) from time series
-    void pruneExtentsFromTime(extents xtents);
-
     //this will move the cache element to the top of the stack
     void promoteElement(double time, extents Xtents);
 
+    //inflates a compressed element back into the raw tier.  Returns the element, or the
+    // extracted holder if the array no longer fits in the cache (NULL on failure).
+    cacheElement* decompressElement(double time, extents xtents);
+
 
 private:
     //this maps time to a specific cachemap
     QMap<double, cacheMap> cache;
 
+    //memory budget shared with other caches (may be NULL for unbounded)
+    cacheBudget* budget;
+
+    //holds sub-extents extracted from a cached superset
+    cacheElement extracted;
+
+    //access stamps for caches without a budget
+    unsigned long clock;
+
     //we need to clean our up
     bool dirty;
 
@@ -1,5 +1,159 @@
 #include "readerCacheManager.h"
+#include "vtkEnlilReader.h"
 
-readerCacheManager::readerCacheManager()
+//=========================================================================================
+readerCacheManager::readerCacheManager(vtkEnlilReader *reader)
 {
+    this->reader = reader;
+    this->pending = false;
+    this->pendingTime = 0;
+    this->busy = false;
+    this->activeTime = 0;
+    this->stopping = false;
+    this->cancelled = 0;
+
+    for(int x = 0; x < 6; x++)
+    {
+        this->pendingExtents[x] = 0;
+    }
+}
+
+//=========================================================================================
+readerCacheManager::~readerCacheManager()
+{
+    this->stop();
+}
+
+//=========================================================================================
+void readerCacheManager::requestTimeStep(double time, const std::vector<std::string> &arrays, const int extents[])
+{
+    QMutexLocker locker(&this->lock);
+
+    //already working on it, or already asked for it
+    if((this->busy && this->activeTime == time) || (this->pending && this->pendingTime == time))
+    {
+        return;
+    }
+
+    //a new prediction replaces whatever we were doing
+    if(this->busy)
+    {
+        this->cancelled = 1;
+    }
+
+    this->pending = true;
+    this->pendingTime = time;
+    this->pendingArrays = arrays;
+
+    for(int x = 0; x < 6; x++)
+    {
+        this->pendingExtents[x] = extents[x];
+    }
+
+    //start the worker the first time we need it
+    if(!this->isRunning())
+    {
+        this->stopping = false;
+        this->start();
+    }
+
+    this->wake.wakeOne();
+}
+
+//=========================================================================================
+void readerCacheManager::cancelUnless(double time)
+{
+    this->cancelOutside(time, time);
+}
+
+//=========================================================================================
+void readerCacheManager::cancelOutside(double first, double last)
+{
+    QMutexLocker locker(&this->lock);
+
+    if(this->pending && (this->pendingTime < first || this->pendingTime > last))
+    {
+        this->pending = false;
+    }
+
+    if(this->busy && (this->activeTime < first || this->activeTime > last))
+    {
+        this->cancelled = 1;
+    }
+}
+
+//=========================================================================================
+void readerCacheManager::cancel()
+{
+    QMutexLocker locker(&this->lock);
+
+    this->pending = false;
+
+    if(this->busy)
+    {
+        this->cancelled = 1;
+    }
+}
+
+//=========================================================================================
+void readerCacheManager::stop()
+{
+    {
+        QMutexLocker locker(&this->lock);
+        this->stopping = true;
+        this->pending = false;
+        this->cancelled = 1;
+        this->wake.wakeOne();
+    }
+
+    if(this->isRunning())
+    {
+        this->wait();
+    }
+}
+
+//=========================================================================================
+void readerCacheManager::run()
+{
+    while(true)
+    {
+        double time;
+        std::vector<std::string> arrays;
+        int extents[6];
+
+        //wait for something to do
+        {
+            QMutexLocker locker(&this->lock);
+
+            while(!this->pending && !this->stopping)
+            {
+                this->wake.wait(&this->lock);
+            }
+
+            if(this->stopping)
+            {
+                break;
+            }
+
+            time = this->pendingTime;
+            arrays = this->pendingArrays;
+            for(int x = 0; x < 6; x++)
+            {
+                extents[x] = this->pendingExtents[x];
+            }
+
+            this->pending = false;
+            this->busy = true;
+            this->activeTime = time;
+            this->cancelled = 0;
+        }
+
+        //read the step into the cache
+        this->reader->prefetchTimeStep(time, arrays, extents);
+
+        {
+            QMutexLocker locker(&this->lock);
+            this->busy = false;
+        }
+    }
 }
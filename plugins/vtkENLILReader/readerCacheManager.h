@@ -1,34 +1,65 @@
 #ifndef READERCACHEMANAGER_H
 #define READERCACHEMANAGER_H
 
-#if __ENVIRONMENT_MAC_OS_X_VERSION_MIN_REQUIRED__ >= 1050
-#include <libkern/OSAtomic.h>
-#endif
+#include <string>
+#include <vector>
 
-#define LOCKED 1
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
 
-class readerCacheManager
+class vtkEnlilReader;
+
+//=========================================================================================
+//background worker that reads a predicted time step into the reader cache while the
+// current one is being rendered.  Only one request is kept: a new request replaces any
+// pending one, and cancel() asks a running read to stop at the next array boundary.
+class readerCacheManager : public QThread
 {
 public:
-    readerCacheManager();
+    readerCacheManager(vtkEnlilReader* reader);
+    ~readerCacheManager();
+
+    //queue a time step (and the arrays/extents to read for it)
+    void requestTimeStep(double time, const std::vector<std::string> &arrays, const int extents[6]);
+
+    //drop any pending request and stop a running one (unless it is reading time)
+    void cancelUnless(double time);
+
+    //same, but keeps requests for any time step from first to last
+    void cancelOutside(double first, double last);
+
+    //drop any pending request and stop a running one
+    void cancel();
+
+    //polled by the reader while prefetching
+    bool isCancelled() { return (int)this->cancelled != 0; }
+
+    //stop the worker thread
+    void stop();
+
+protected:
+    virtual void run();
 
 private:
+    vtkEnlilReader* reader;
+
+    QMutex lock;
+    QWaitCondition wake;
 
-    bool TestAndSet(volatile int* lock)
-    {
-        int old_value = 0;
-#if __ENVIRONMENT_MAC_OS_X_VERSION_MIN_REQUIRED__ >= 1050
-        return OSAtomicCompareAndSwapInt (old_value, 1, lock);
-#elif defined(_MSC_VER)
-        return InterlockedCompareExchange(lock, 1, old_value);
-#elif (__GNUC__ * 10000 + __GNUC_MINOR__ * 100 + __GNUC_PATCHLEVEL__) > 40100
-        return __sync_val_compare_and_swap(lock, old_value, 1);
-#else
-#  error No implementation
-#endif
-    }
+    //the pending request
+    bool pending;
+    double pendingTime;
+    std::vector<std::string> pendingArrays;
+    int pendingExtents[6];
 
+    //time step being read right now (valid while busy)
+    bool busy;
+    double activeTime;
 
+    QAtomicInt cancelled;
+    bool stopping;
 };
 
 #endif // READERCACHEMANAGER_H
@@ -0,0 +1,201 @@
+#include "readerCompressedArray.h"
+
+#include "vtkFloatArray.h"
+#include "vtkSMPTools.h"
+#include "vtk_zlib.h"
+
+#include <algorithm>
+
+//number of values per compressed block (1 MB of floats)
+static const long long blockSize = 1 << 18;
+
+//=========================================================================================
+//shuffles and deflates blocks of values.  A failed block is left empty.
+struct compressedArrayPacker
+{
+    const float* values;
+    long long numValues;
+    int level;
+
+    std::vector<std::vector<unsigned char> >* blocks;
+    std::vector<long long>* blockValues;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        std::vector<unsigned char> shuffled;
+
+        for(vtkIdType b = begin; b < end; b++)
+        {
+            long long first = b*blockSize;
+            long long count = std::min(blockSize, this->numValues - first);
+
+            (*this->blockValues)[b] = count;
+
+            //byte planes: byte n of every value is stored at n*count + value
+            const unsigned char* source = reinterpret_cast<const unsigned char*>(this->values + first);
+            shuffled.resize(count*sizeof(float));
+
+            for(long long v = 0; v < count; v++)
+            {
+                for(size_t n = 0; n < sizeof(float); n++)
+                {
+                    shuffled[n*count + v] = source[v*sizeof(float) + n];
+                }
+            }
+
+            std::vector<unsigned char> &block = (*this->blocks)[b];
+            uLongf packedSize = compressBound(static_cast<uLong>(shuffled.size()));
+            block.resize(packedSize);
+
+            if(compress2(&block[0], &packedSize, &shuffled[0], static_cast<uLong>(shuffled.size()), this->level) != Z_OK)
+            {
+                std::vector<unsigned char>().swap(block);
+                continue;
+            }
+
+            //give back the unused part of the bound
+            std::vector<unsigned char>(block.begin(), block.begin() + packedSize).swap(block);
+        }
+    }
+};
+
+//=========================================================================================
+//inflates and unshuffles blocks of values.  Clears ok if a block is damaged.
+struct compressedArrayUnpacker
+{
+    const std::vector<std::vector<unsigned char> >* blocks;
+    const std::vector<long long>* blockValues;
+
+    float* values;
+    bool ok;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        std::vector<unsigned char> shuffled;
+
+        for(vtkIdType b = begin; b < end; b++)
+        {
+            const std::vector<unsigned char> &block = (*this->blocks)[b];
+            long long count = (*this->blockValues)[b];
+
+            uLongf rawSize = static_cast<uLongf>(count*sizeof(float));
+            shuffled.resize(rawSize);
+
+            if(uncompress(&shuffled[0], &rawSize, &block[0], static_cast<uLong>(block.size())) != Z_OK
+                    || rawSize != count*sizeof(float))
+            {
+                this->ok = false;
+                continue;
+            }
+
+            unsigned char* destination = reinterpret_cast<unsigned char*>(this->values + b*blockSize);
+
+            for(long long v = 0; v < count; v++)
+            {
+                for(size_t n = 0; n < sizeof(float); n++)
+                {
+                    destination[v*sizeof(float) + n] = shuffled[n*count + v];
+                }
+            }
+        }
+    }
+};
+
+//=========================================================================================
+readerCompressedArray::readerCompressedArray()
+{
+    this->numComponents = 0;
+    this->numTuples = 0;
+}
+
+//=========================================================================================
+readerCompressedArray::~readerCompressedArray()
+{
+}
+
+//=========================================================================================
+bool readerCompressedArray::compress(vtkAbstractArray *array, int level)
+{
+    this->blocks.clear();
+    this->blockValues.clear();
+
+    vtkFloatArray* floats = vtkFloatArray::SafeDownCast(array);
+    if(floats == NULL || floats->GetNumberOfTuples() == 0)
+    {
+        return false;
+    }
+
+    this->name = (floats->GetName() != NULL) ? floats->GetName() : "";
+    this->numComponents = floats->GetNumberOfComponents();
+    this->numTuples = floats->GetNumberOfTuples();
+
+    long long numValues = this->numTuples*this->numComponents;
+    vtkIdType numBlocks = static_cast<vtkIdType>((numValues + blockSize - 1)/blockSize);
+
+    this->blocks.resize(numBlocks);
+    this->blockValues.resize(numBlocks);
+
+    compressedArrayPacker packer;
+    packer.values = floats->GetPointer(0);
+    packer.numValues = numValues;
+    packer.level = level;
+    packer.blocks = &this->blocks;
+    packer.blockValues = &this->blockValues;
+
+    vtkSMPTools::For(0, numBlocks, 1, packer);
+
+    for(size_t b = 0; b < this->blocks.size(); b++)
+    {
+        if(this->blocks[b].empty())
+        {
+            this->blocks.clear();
+            this->blockValues.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//=========================================================================================
+vtkAbstractArray *readerCompressedArray::decompress() const
+{
+    if(this->blocks.empty())
+    {
+        return NULL;
+    }
+
+    vtkFloatArray* array = vtkFloatArray::New();
+    array->SetName(this->name.c_str());
+    array->SetNumberOfComponents(this->numComponents);
+    array->SetNumberOfTuples(this->numTuples);
+
+    compressedArrayUnpacker unpacker;
+    unpacker.blocks = &this->blocks;
+    unpacker.blockValues = &this->blockValues;
+    unpacker.values = array->GetPointer(0);
+    unpacker.ok = true;
+
+    vtkSMPTools::For(0, static_cast<vtkIdType>(this->blocks.size()), 1, unpacker);
+
+    if(!unpacker.ok)
+    {
+        array->Delete();
+        return NULL;
+    }
+
+    return array;
+}
+
+//=========================================================================================
+double readerCompressedArray::getSize() const
+{
+    double size = sizeof(*this);
+
+    for(size_t b = 0; b < this->blocks.size(); b++)
+    {
+        size += this->blocks[b].size();
+    }
+
+    return size;
+}
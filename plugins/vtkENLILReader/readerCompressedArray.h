@@ -0,0 +1,39 @@
+#ifndef READERCOMPRESSEDARRAY_H
+#define READERCOMPRESSEDARRAY_H
+
+#include <string>
+#include <vector>
+
+class vtkAbstractArray;
+
+//=========================================================================================
+//a float array held in compressed blocks, for the second (compressed) tier of the reader
+// cache.  Every block is byte-shuffled (the first bytes of all values, then the second
+// bytes, ...) so the slowly varying exponents of neighbouring values line up, and then
+// deflated.  Blocks are independent, so they are compressed and inflated in parallel.
+class readerCompressedArray
+{
+public:
+    readerCompressedArray();
+    ~readerCompressedArray();
+
+    //compresses array (only vtkFloatArray is supported).  Returns false on failure.
+    bool compress(vtkAbstractArray* array, int level = 1);
+
+    //returns a NEW array (caller must Delete()) with the original values, or NULL on failure
+    vtkAbstractArray* decompress() const;
+
+    //memory used by the compressed blocks (in bytes)
+    double getSize() const;
+
+protected:
+    std::string name;
+    int numComponents;
+    long long numTuples;
+
+    //compressed bytes of every block, and the number of values in it
+    std::vector<std::vector<unsigned char> > blocks;
+    std::vector<long long> blockValues;
+};
+
+#endif // READERCOMPRESSEDARRAY_H
@@ -0,0 +1,153 @@
+#include "readerFilePool.h"
+#include "readerMappedFile.h"
+
+#include "vtk_netcdfcpp.h"
+#include <iostream>
+
+//=========================================================================================
+readerFilePool::readerFilePool(int maxOpenFiles)
+{
+    this->maxOpenFiles = (maxOpenFiles > 0) ? maxOpenFiles : 1;
+}
+
+//=========================================================================================
+readerFilePool::~readerFilePool()
+{
+    this->closeAll();
+}
+
+//=========================================================================================
+QMutex& readerFilePool::libraryLock()
+{
+    static QMutex lock(QMutex::Recursive);
+    return lock;
+}
+
+//=========================================================================================
+NcFile* readerFilePool::getFile(const std::string &fileName)
+{
+    QMutexLocker library(&libraryLock());
+
+    //look for the file in the pool, promoting it to the front if found
+    for(int x = 0; x < this->openFiles.size(); x++)
+    {
+        if(this->openFiles[x].first == fileName)
+        {
+            if(x != 0)
+            {
+                this->openFiles.move(x, 0);
+            }
+
+            return this->openFiles[0].second;
+        }
+    }
+
+    //not open yet, so open it
+    NcFile* file = new NcFile(fileName.c_str());
+
+    if(!file->is_valid())
+    {
+        std::cerr << "Failed to open file " << fileName << std::endl;
+        delete file;
+        return NULL;
+    }
+
+    //make room, then add to the front
+    this->pruneTo(this->maxOpenFiles - 1);
+    this->openFiles.prepend(qMakePair(fileName, file));
+
+    return file;
+}
+
+//=========================================================================================
+readerMappedFile* readerFilePool::getMappedFile(const std::string &fileName)
+{
+    //look for the map in the pool, promoting it to the front if found
+    for(int x = 0; x < this->mappedFiles.size(); x++)
+    {
+        if(this->mappedFiles[x].first == fileName)
+        {
+            if(x != 0)
+            {
+                this->mappedFiles.move(x, 0);
+            }
+
+            return this->mappedFiles[0].second;
+        }
+    }
+
+    //not mapped yet, so try to map it
+    readerMappedFile* map = new readerMappedFile;
+
+    if(!map->open(fileName))
+    {
+        delete map;
+        map = NULL;
+    }
+
+    //make room, then add to the front
+    while(this->mappedFiles.size() >= this->maxOpenFiles)
+    {
+        delete this->mappedFiles.takeLast().second;
+    }
+    this->mappedFiles.prepend(qMakePair(fileName, map));
+
+    return map;
+}
+
+//=========================================================================================
+void readerFilePool::closeFile(const std::string &fileName)
+{
+    QMutexLocker library(&libraryLock());
+
+    for(int x = 0; x < this->mappedFiles.size(); x++)
+    {
+        if(this->mappedFiles[x].first == fileName)
+        {
+            delete this->mappedFiles.takeAt(x).second;
+            break;
+        }
+    }
+
+    for(int x = 0; x < this->openFiles.size(); x++)
+    {
+        if(this->openFiles[x].first == fileName)
+        {
+            NcFile* file = this->openFiles.takeAt(x).second;
+            file->close();
+            delete file;
+            return;
+        }
+    }
+}
+
+//=========================================================================================
+void readerFilePool::closeAll()
+{
+    this->pruneTo(0);
+}
+
+//=========================================================================================
+void readerFilePool::setMaximumOpenFiles(int maxOpenFiles)
+{
+    this->maxOpenFiles = (maxOpenFiles > 0) ? maxOpenFiles : 1;
+    this->pruneTo(this->maxOpenFiles);
+}
+
+//=========================================================================================
+void readerFilePool::pruneTo(int count)
+{
+    QMutexLocker library(&libraryLock());
+
+    while(this->openFiles.size() > count && !this->openFiles.isEmpty())
+    {
+        NcFile* file = this->openFiles.takeLast().second;
+        file->close();
+        delete file;
+    }
+
+    while(this->mappedFiles.size() > count && !this->mappedFiles.isEmpty())
+    {
+        delete this->mappedFiles.takeLast().second;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef READERFILEPOOL_H
+#define READERFILEPOOL_H
+
+#include <string>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+
+class NcFile;
+class readerMappedFile;
+
+//=========================================================================================
+//keeps a bounded number of NetCDF files open so that the read paths of a reader
+// can share one handle (and one header parse) per file instead of re-opening it
+// for every variable.  Files are closed in least recently used order.
+class readerFilePool
+{
+public:
+    readerFilePool(int maxOpenFiles = 8);
+    ~readerFilePool();
+
+    //returns an open handle for fileName (NULL if it cannot be opened).
+    // The pool owns the handle; do NOT close or delete it.
+    NcFile* getFile(const std::string &fileName);
+
+    //returns a memory map of fileName, or NULL if it is not a classic NetCDF file
+    // (or cannot be mapped) and has to be read through getFile().  The pool owns the map.
+    readerMappedFile* getMappedFile(const std::string &fileName);
+
+    //closes a single file if it is open
+    void closeFile(const std::string &fileName);
+
+    //closes all of the open files
+    void closeAll();
+
+    //limit on the number of files held open
+    void setMaximumOpenFiles(int maxOpenFiles);
+    int getMaximumOpenFiles() { return this->maxOpenFiles; }
+
+    //number of files currently open
+    int getNumberOpenFiles() { return this->openFiles.size(); }
+
+    //the NetCDF library is not thread safe, so every call into it (from any reader,
+    // on any thread) must hold this lock.  It is recursive, and the pool takes it itself.
+    static QMutex& libraryLock();
+
+protected:
+    //close files until at most count are open
+    void pruneTo(int count);
+
+    //most recently used files are at the front
+    QList<QPair<std::string, NcFile*> > openFiles;
+
+    //same for the maps. Files that cannot be mapped are kept with a NULL map,
+    // so they are not probed again.
+    QList<QPair<std::string, readerMappedFile*> > mappedFiles;
+
+    int maxOpenFiles;
+
+private:
+    readerFilePool(const readerFilePool&);  // Not implemented.
+    void operator=(const readerFilePool&);  // Not implemented.
+};
+
+#endif // READERFILEPOOL_H
@@ -0,0 +1,152 @@
+#include "readerMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//=========================================================================================
+readerMappedFile::readerMappedFile()
+{
+    this->data = NULL;
+    this->size = 0;
+
+#ifdef _WIN32
+    this->fileHandle = NULL;
+    this->mapHandle = NULL;
+#endif
+}
+
+//=========================================================================================
+readerMappedFile::~readerMappedFile()
+{
+    this->close();
+}
+
+//=========================================================================================
+bool readerMappedFile::open(const std::string &fileName)
+{
+    this->close();
+
+    //only classic files have their variables at fixed offsets
+    if(!this->header.read(fileName))
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE map = NULL;
+    void* view = NULL;
+
+    if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    if(map != NULL)
+    {
+        view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if(view == NULL)
+    {
+        if(map != NULL)
+        {
+            CloseHandle(map);
+        }
+        CloseHandle(file);
+        return false;
+    }
+
+    this->fileHandle = file;
+    this->mapHandle = map;
+    this->data = (unsigned char*)view;
+    this->size = fileSize.QuadPart;
+#else
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    if(file < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    void* view = MAP_FAILED;
+
+    if(fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        view = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, file, 0);
+    }
+
+    //the mapping keeps the file alive
+    ::close(file);
+
+    if(view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    this->data = (unsigned char*)view;
+    this->size = info.st_size;
+#endif
+
+    return true;
+}
+
+//=========================================================================================
+void readerMappedFile::close()
+{
+    if(this->data == NULL)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(this->data);
+    CloseHandle((HANDLE)this->mapHandle);
+    CloseHandle((HANDLE)this->fileHandle);
+    this->fileHandle = NULL;
+    this->mapHandle = NULL;
+#else
+    munmap(this->data, this->size);
+#endif
+
+    this->data = NULL;
+    this->size = 0;
+}
+
+//=========================================================================================
+const unsigned char* readerMappedFile::getData(const readerNc3Header::variable &var, unsigned long long rec) const
+{
+    if(this->data == NULL)
+    {
+        return NULL;
+    }
+
+    //one record of the variable has to be in the file
+    unsigned long long count = 1;
+    for(size_t d = var.isRecord ? 1 : 0; d < var.shape.size(); d++)
+    {
+        count *= var.shape[d];
+    }
+
+    unsigned long long begin = this->header.getOffset(var, 0, rec);
+    unsigned long long end = begin + count*readerNc3Header::typeSize(var.type);
+
+    if(end > this->size || end < begin)
+    {
+        return NULL;
+    }
+
+    return this->data + begin;
+}
@@ -0,0 +1,44 @@
+#ifndef READERMAPPEDFILE_H
+#define READERMAPPEDFILE_H
+
+#include <string>
+#include "readerNc3Header.h"
+
+//=========================================================================================
+//a read-only memory map of a classic NetCDF file together with its parsed header.
+// Variables are located from the header, so their (big-endian) values can be converted
+// straight out of the page cache without going through the NetCDF library.
+class readerMappedFile
+{
+public:
+    readerMappedFile();
+    ~readerMappedFile();
+
+    //maps fileName. Returns false if it is not a classic file or cannot be mapped.
+    bool open(const std::string &fileName);
+    void close();
+
+    bool isOpen() const { return this->data != NULL; }
+
+    const readerNc3Header& getHeader() const { return this->header; }
+
+    //first byte of var (of record rec), or NULL if the variable lies outside of the file
+    const unsigned char* getData(const readerNc3Header::variable &var, unsigned long long rec = 0) const;
+
+protected:
+    readerNc3Header header;
+
+    unsigned char* data;
+    unsigned long long size;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mapHandle;
+#endif
+
+private:
+    readerMappedFile(const readerMappedFile&);  // Not implemented.
+    void operator=(const readerMappedFile&);    // Not implemented.
+};
+
+#endif // READERMAPPEDFILE_H
@@ -0,0 +1,419 @@
+#include "readerNc3Header.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#define nc3Seek _fseeki64
+#else
+#define nc3Seek fseeko
+#endif
+
+//header tags
+#define NC3_DIMENSION 0x0A
+#define NC3_VARIABLE  0x0B
+#define NC3_ATTRIBUTE 0x0C
+
+//=========================================================================================
+void readerNc3Swap(void* data, int size)
+{
+    //NetCDF classic files are always big-endian
+    const unsigned short one = 1;
+    if(*(const unsigned char*)&one == 0)
+    {
+        return;
+    }
+
+    unsigned char* bytes = (unsigned char*)data;
+    for(int x = 0; x < size/2; x++)
+    {
+        unsigned char temp = bytes[x];
+        bytes[x] = bytes[size-1-x];
+        bytes[size-1-x] = temp;
+    }
+}
+
+//=========================================================================================
+//converts one big-endian value of the given type to double
+static double toDouble(const unsigned char* data, int type)
+{
+    unsigned char item[8];
+    int size = readerNc3Header::typeSize(type);
+    memcpy(item, data, size);
+    readerNc3Swap(item, size);
+
+    signed char b;
+    short s;
+    int i;
+    float f;
+    double d;
+
+    switch(type)
+    {
+    case readerNc3Header::NC3_BYTE:
+        memcpy(&b, item, 1);
+        return b;
+    case readerNc3Header::NC3_SHORT:
+        memcpy(&s, item, 2);
+        return s;
+    case readerNc3Header::NC3_INT:
+        memcpy(&i, item, 4);
+        return i;
+    case readerNc3Header::NC3_FLOAT:
+        memcpy(&f, item, 4);
+        return f;
+    default:
+        memcpy(&d, item, 8);
+        return d;
+    }
+}
+
+//=========================================================================================
+readerNc3Header::readerNc3Header()
+{
+    this->version = 0;
+    this->numRecords = 0;
+    this->recordSize = 0;
+}
+
+//=========================================================================================
+int readerNc3Header::typeSize(int type)
+{
+    switch(type)
+    {
+    case NC3_BYTE:
+    case NC3_CHAR:
+        return 1;
+    case NC3_SHORT:
+        return 2;
+    case NC3_INT:
+    case NC3_FLOAT:
+        return 4;
+    case NC3_DOUBLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+//=========================================================================================
+bool readerNc3Header::read(const std::string &fileName)
+{
+    this->fileName = fileName;
+    this->version = 0;
+    this->numRecords = 0;
+    this->recordSize = 0;
+    this->dimensions.clear();
+    this->attributes.clear();
+    this->variables.clear();
+
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    bool status = true;
+    unsigned char magic[4];
+    unsigned int value, tag, count;
+
+    //magic: 'C' 'D' 'F' version.  Only CDF-1 and CDF-2 are handled.
+    if(fread(magic, 1, 4, file) != 4 || magic[0] != 'C' || magic[1] != 'D' || magic[2] != 'F'
+            || (magic[3] != 1 && magic[3] != 2))
+    {
+        fclose(file);
+        return false;
+    }
+    this->version = magic[3];
+
+    //number of records (0xFFFFFFFF while the file is still being written)
+    status = this->readUInt32(file, value);
+    this->numRecords = (value == 0xFFFFFFFF) ? 0 : value;
+
+    //dimensions
+    status = status && this->readUInt32(file, tag) && this->readUInt32(file, count);
+    if(status && tag == NC3_DIMENSION)
+    {
+        this->dimensions.resize(count);
+        for(unsigned int x = 0; status && x < count; x++)
+        {
+            status = this->readName(file, this->dimensions[x].name)
+                    && this->readUInt32(file, value);
+            this->dimensions[x].length = value;
+        }
+    }
+    else if(status && (tag != 0 || count != 0))
+    {
+        status = false;
+    }
+
+    //global attributes
+    status = status && this->readAttributes(file, this->attributes);
+
+    //variables
+    status = status && this->readUInt32(file, tag) && this->readUInt32(file, count);
+    if(status && tag == NC3_VARIABLE)
+    {
+        this->variables.resize(count);
+        for(unsigned int x = 0; status && x < count; x++)
+        {
+            variable &var = this->variables[x];
+            unsigned int ndims = 0;
+            status = this->readName(file, var.name) && this->readUInt32(file, ndims);
+
+            var.isRecord = false;
+            for(unsigned int d = 0; status && d < ndims; d++)
+            {
+                status = this->readUInt32(file, value) && value < this->dimensions.size();
+                if(status)
+                {
+                    var.dimIDs.push_back(value);
+                    unsigned long long length = this->dimensions[value].length;
+                    if(length == 0)
+                    {
+                        var.isRecord = (d == 0);
+                        length = 1;
+                    }
+                    var.shape.push_back(length);
+                }
+            }
+
+            status = status && this->readAttributes(file, var.attributes)
+                    && this->readUInt32(file, value);
+            var.type = value;
+
+            status = status && this->readUInt32(file, value);
+            var.vsize = value;
+
+            if(this->version == 1)
+            {
+                status = status && this->readUInt32(file, value);
+                var.begin = value;
+            }
+            else
+            {
+                status = status && this->readUInt64(file, var.begin);
+            }
+        }
+    }
+    else if(status && (tag != 0 || count != 0))
+    {
+        status = false;
+    }
+
+    fclose(file);
+
+    if(!status)
+    {
+        return false;
+    }
+
+    //size of one record.  A file with a single record variable does not pad its records.
+    int numRecordVars = 0;
+    for(size_t x = 0; x < this->variables.size(); x++)
+    {
+        if(this->variables[x].isRecord)
+        {
+            numRecordVars++;
+            this->recordSize += this->variables[x].vsize;
+        }
+    }
+
+    if(numRecordVars == 1)
+    {
+        for(size_t x = 0; x < this->variables.size(); x++)
+        {
+            const variable &var = this->variables[x];
+            if(var.isRecord)
+            {
+                unsigned long long size = typeSize(var.type);
+                for(size_t d = 1; d < var.shape.size(); d++)
+                {
+                    size *= var.shape[d];
+                }
+                this->recordSize = size;
+            }
+        }
+    }
+
+    return true;
+}
+
+//=========================================================================================
+const readerNc3Header::variable* readerNc3Header::getVariable(const std::string &name) const
+{
+    for(size_t x = 0; x < this->variables.size(); x++)
+    {
+        if(this->variables[x].name == name)
+        {
+            return &this->variables[x];
+        }
+    }
+
+    return NULL;
+}
+
+//=========================================================================================
+const readerNc3Header::attribute* readerNc3Header::getAttribute(const std::string &name) const
+{
+    for(size_t x = 0; x < this->attributes.size(); x++)
+    {
+        if(this->attributes[x].name == name)
+        {
+            return &this->attributes[x];
+        }
+    }
+
+    return NULL;
+}
+
+//=========================================================================================
+unsigned long long readerNc3Header::getOffset(const variable &var, unsigned long long element, unsigned long long rec) const
+{
+    unsigned long long offset = var.begin + element*typeSize(var.type);
+
+    if(var.isRecord)
+    {
+        offset += rec*this->recordSize;
+    }
+
+    return offset;
+}
+
+//=========================================================================================
+bool readerNc3Header::readValue(const std::string &varName, unsigned long long element, double &value) const
+{
+    const variable* var = this->getVariable(varName);
+    if(var == NULL || var->type == NC3_CHAR || typeSize(var->type) == 0)
+    {
+        return false;
+    }
+
+    FILE* file = fopen(this->fileName.c_str(), "rb");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    unsigned char buffer[8];
+    int size = typeSize(var->type);
+    bool status = nc3Seek(file, this->getOffset(*var, element), SEEK_SET) == 0
+            && fread(buffer, 1, size, file) == (size_t)size;
+    fclose(file);
+
+    if(!status)
+    {
+        return false;
+    }
+
+    value = toDouble(buffer, var->type);
+    return true;
+}
+
+//=========================================================================================
+bool readerNc3Header::readUInt32(FILE* file, unsigned int &value)
+{
+    if(fread(&value, 4, 1, file) != 1)
+    {
+        return false;
+    }
+
+    readerNc3Swap(&value, 4);
+    return true;
+}
+
+//=========================================================================================
+bool readerNc3Header::readUInt64(FILE* file, unsigned long long &value)
+{
+    if(fread(&value, 8, 1, file) != 1)
+    {
+        return false;
+    }
+
+    readerNc3Swap(&value, 8);
+    return true;
+}
+
+//=========================================================================================
+bool readerNc3Header::skipPadding(FILE* file, unsigned long long bytes)
+{
+    unsigned long long pad = (4 - bytes % 4) % 4;
+    return pad == 0 || fseek(file, (long)pad, SEEK_CUR) == 0;
+}
+
+//=========================================================================================
+bool readerNc3Header::readName(FILE* file, std::string &name)
+{
+    unsigned int length = 0;
+    if(!this->readUInt32(file, length))
+    {
+        return false;
+    }
+
+    name.resize(length);
+    if(length > 0 && fread(&name[0], 1, length, file) != length)
+    {
+        return false;
+    }
+
+    return this->skipPadding(file, length);
+}
+
+//=========================================================================================
+bool readerNc3Header::readAttributes(FILE* file, std::vector<attribute> &atts)
+{
+    unsigned int tag, count;
+    if(!this->readUInt32(file, tag) || !this->readUInt32(file, count))
+    {
+        return false;
+    }
+
+    if(tag != NC3_ATTRIBUTE)
+    {
+        //ABSENT is two zero words
+        return tag == 0 && count == 0;
+    }
+
+    atts.resize(count);
+    for(unsigned int x = 0; x < count; x++)
+    {
+        attribute &att = atts[x];
+        unsigned int type, nelems;
+        if(!this->readName(file, att.name) || !this->readUInt32(file, type) || !this->readUInt32(file, nelems))
+        {
+            return false;
+        }
+        att.type = type;
+
+        int size = typeSize(type);
+        if(size == 0)
+        {
+            return false;
+        }
+
+        std::vector<unsigned char> buffer((size_t)size*nelems + 8);
+        if(nelems > 0 && fread(&buffer[0], size, nelems, file) != nelems)
+        {
+            return false;
+        }
+
+        if(type == NC3_CHAR)
+        {
+            att.text.assign((const char*)&buffer[0], nelems);
+        }
+        else
+        {
+            att.values.resize(nelems);
+            for(unsigned int v = 0; v < nelems; v++)
+            {
+                att.values[v] = toDouble(&buffer[(size_t)v*size], type);
+            }
+        }
+
+        if(!this->skipPadding(file, (unsigned long long)size*nelems))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
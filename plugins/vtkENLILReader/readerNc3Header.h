@@ -0,0 +1,101 @@
+#ifndef READERNC3HEADER_H
+#define READERNC3HEADER_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+//=========================================================================================
+//minimal parser for the header of a classic (CDF-1) or 64-bit offset (CDF-2) NetCDF file.
+// It does not touch the NetCDF library, so several of these can be used at once from
+// different threads.  NetCDF-4/HDF5 files are not understood; read() returns false for
+// them and the caller should fall back to the library.
+class readerNc3Header
+{
+public:
+    //NetCDF external types
+    enum ncType
+    {
+        NC3_BYTE = 1,
+        NC3_CHAR = 2,
+        NC3_SHORT = 3,
+        NC3_INT = 4,
+        NC3_FLOAT = 5,
+        NC3_DOUBLE = 6
+    };
+
+    struct dimension
+    {
+        std::string name;
+        unsigned long long length;      //0 for the record dimension
+    };
+
+    struct attribute
+    {
+        std::string name;
+        int type;
+        std::vector<double> values;     //numeric attributes
+        std::string text;               //NC3_CHAR attributes
+    };
+
+    struct variable
+    {
+        std::string name;
+        std::vector<int> dimIDs;
+        std::vector<unsigned long long> shape;  //record dimension reported as 1
+        std::vector<attribute> attributes;
+        int type;
+        unsigned long long vsize;
+        unsigned long long begin;       //file offset of the data (of record 0 for record vars)
+        bool isRecord;
+    };
+
+    readerNc3Header();
+
+    //parse the header of fileName. Returns false if the file is not a classic file.
+    bool read(const std::string &fileName);
+
+    const std::string& getFileName() const { return this->fileName; }
+    int getVersion() const { return this->version; }
+
+    unsigned long long getNumberOfRecords() const { return this->numRecords; }
+    unsigned long long getRecordSize() const { return this->recordSize; }
+
+    const std::vector<dimension>& getDimensions() const { return this->dimensions; }
+    const std::vector<attribute>& getAttributes() const { return this->attributes; }
+    const std::vector<variable>& getVariables() const { return this->variables; }
+
+    //lookups by name, NULL if not present
+    const variable* getVariable(const std::string &name) const;
+    const attribute* getAttribute(const std::string &name) const;
+
+    //size in bytes of one value of the given type
+    static int typeSize(int type);
+
+    //file offset of element (of record rec) of var
+    unsigned long long getOffset(const variable &var, unsigned long long element, unsigned long long rec = 0) const;
+
+    //read a single value of a numeric variable as double
+    bool readValue(const std::string &varName, unsigned long long element, double &value) const;
+
+protected:
+    bool readUInt32(FILE* file, unsigned int &value);
+    bool readUInt64(FILE* file, unsigned long long &value);
+    bool readName(FILE* file, std::string &name);
+    bool readAttributes(FILE* file, std::vector<attribute> &atts);
+    bool skipPadding(FILE* file, unsigned long long bytes);
+
+    std::string fileName;
+    int version;
+    unsigned long long numRecords;
+    unsigned long long recordSize;
+
+    std::vector<dimension> dimensions;
+    std::vector<attribute> attributes;
+    std::vector<variable> variables;
+};
+
+//convert a big-endian value in place
+void readerNc3Swap(void* data, int size);
+
+#endif // READERNC3HEADER_H
@@ -0,0 +1,160 @@
+#include "readerTimeIndex.h"
+
+#include "vtksys/SystemTools.hxx"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#define ENLIL_TIME_INDEX_NAME ".enlil_time_index"
+#define ENLIL_TIME_INDEX_VERSION "# ENLIL time index 1"
+
+//=========================================================================================
+readerTimeIndex::readerTimeIndex()
+{
+    this->modified = false;
+}
+
+//=========================================================================================
+std::string readerTimeIndex::getIndexFileName(const std::string &fileName)
+{
+    std::string path = vtksys::SystemTools::GetFilenamePath(fileName);
+
+    if(path.empty())
+    {
+        return ENLIL_TIME_INDEX_NAME;
+    }
+
+    return path + "/" + ENLIL_TIME_INDEX_NAME;
+}
+
+//=========================================================================================
+bool readerTimeIndex::getFileStamp(const std::string &fileName, unsigned long &size, long &modifiedTime)
+{
+    if(!vtksys::SystemTools::FileExists(fileName))
+    {
+        return false;
+    }
+
+    size = vtksys::SystemTools::FileLength(fileName);
+    modifiedTime = vtksys::SystemTools::ModifiedTime(fileName);
+
+    return true;
+}
+
+//=========================================================================================
+bool readerTimeIndex::load(const std::string &indexFileName)
+{
+    std::ifstream in(indexFileName.c_str());
+    if(!in)
+    {
+        return false;
+    }
+
+    std::string line;
+    if(!std::getline(in, line) || line != ENLIL_TIME_INDEX_VERSION)
+    {
+        return false;
+    }
+
+    //one tab separated entry per line:
+    // path  size  mtime  mjd  physical time  date string
+    while(std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string fileName, size, mtime, mjd, physicalTime, dateString;
+
+        if(!std::getline(fields, fileName, '\t') || !std::getline(fields, size, '\t')
+                || !std::getline(fields, mtime, '\t') || !std::getline(fields, mjd, '\t')
+                || !std::getline(fields, physicalTime, '\t'))
+        {
+            continue;
+        }
+        std::getline(fields, dateString);
+
+        entry item;
+        item.fileName = fileName;
+        item.fileSize = strtoul(size.c_str(), NULL, 10);
+        item.modifiedTime = strtol(mtime.c_str(), NULL, 10);
+        item.mjd = strtod(mjd.c_str(), NULL);
+        item.physicalTime = strtod(physicalTime.c_str(), NULL);
+        item.dateString = dateString;
+
+        this->entries[fileName] = item;
+    }
+
+    this->modified = false;
+    return true;
+}
+
+//=========================================================================================
+bool readerTimeIndex::save(const std::string &indexFileName)
+{
+    //write next to the index and move it into place, so a reader never sees half a file
+    std::string tempName = indexFileName + ".tmp";
+
+    {
+        std::ofstream out(tempName.c_str());
+        if(!out)
+        {
+            return false;
+        }
+
+        out << ENLIL_TIME_INDEX_VERSION << std::endl;
+        out << std::setprecision(17);
+
+        std::map<std::string, entry>::const_iterator iter;
+        for(iter = this->entries.begin(); iter != this->entries.end(); ++iter)
+        {
+            const entry &item = iter->second;
+            out << item.fileName << "\t" << item.fileSize << "\t" << item.modifiedTime << "\t"
+                << item.mjd << "\t" << item.physicalTime << "\t" << item.dateString << std::endl;
+        }
+
+        if(!out)
+        {
+            out.close();
+            remove(tempName.c_str());
+            return false;
+        }
+    }
+
+    remove(indexFileName.c_str());
+    if(rename(tempName.c_str(), indexFileName.c_str()) != 0)
+    {
+        remove(tempName.c_str());
+        return false;
+    }
+
+    this->modified = false;
+    return true;
+}
+
+//=========================================================================================
+bool readerTimeIndex::lookup(const std::string &fileName, entry &result) const
+{
+    std::map<std::string, entry>::const_iterator iter = this->entries.find(fileName);
+    if(iter == this->entries.end())
+    {
+        return false;
+    }
+
+    unsigned long size;
+    long mtime;
+    if(!getFileStamp(fileName, size, mtime) || size != iter->second.fileSize || mtime != iter->second.modifiedTime)
+    {
+        return false;
+    }
+
+    result = iter->second;
+    return true;
+}
+
+//=========================================================================================
+void readerTimeIndex::update(const entry &result)
+{
+    this->entries[result.fileName] = result;
+    this->modified = true;
+}
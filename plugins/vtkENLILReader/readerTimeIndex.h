@@ -0,0 +1,55 @@
+#ifndef READERTIMEINDEX_H
+#define READERTIMEINDEX_H
+
+#include <string>
+#include <map>
+
+//=========================================================================================
+//sidecar index of the time information of a series of ENLIL files.  Each entry is keyed
+// by file path and is only trusted while the file size and modification time still
+// match, so reopening an unchanged run does not have to touch the data files at all.
+class readerTimeIndex
+{
+public:
+    struct entry
+    {
+        entry() : fileSize(0), modifiedTime(0), mjd(0), physicalTime(0) {}
+
+        std::string fileName;
+        unsigned long fileSize;
+        long modifiedTime;
+
+        double mjd;
+        double physicalTime;
+        std::string dateString;
+    };
+
+    readerTimeIndex();
+
+    //where the index for a series containing fileName lives (next to the data)
+    static std::string getIndexFileName(const std::string &fileName);
+
+    //current size and modification time of fileName
+    static bool getFileStamp(const std::string &fileName, unsigned long &size, long &modifiedTime);
+
+    //read/write the index file. save() quietly fails on read-only directories.
+    bool load(const std::string &indexFileName);
+    bool save(const std::string &indexFileName);
+
+    //fills result if fileName is in the index and unchanged on disk
+    bool lookup(const std::string &fileName, entry &result) const;
+
+    //add or replace the entry for result.fileName
+    void update(const entry &result);
+
+    //true if entries were added since the last load/save
+    bool isModified() const { return this->modified; }
+
+    int getNumberOfEntries() const { return (int)this->entries.size(); }
+
+protected:
+    std::map<std::string, entry> entries;
+    bool modified;
+};
+
+#endif // READERTIMEINDEX_H
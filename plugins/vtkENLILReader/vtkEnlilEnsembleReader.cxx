@@ -0,0 +1,679 @@
+#include "vtkEnlilEnsembleReader.h"
+#include "vtkEnlilReader.h"
+
+#include "vtkCallbackCommand.h"
+#include "vtkDataArraySelection.h"
+#include "vtkFloatArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkIntArray.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkSMPTools.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkStructuredGrid.h"
+#include "vtksys/Directory.hxx"
+#include "vtksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+vtkStandardNewMacro(vtkEnlilEnsembleReader)
+
+
+//---------------------------------------------------------------
+//    Threaded kernels
+//---------------------------------------------------------------
+
+//statistics of the members at every point of a slab.  values holds the slab of
+// every member, one after the other.  Mean and variance are accumulated with
+// Welford's update; percentiles interpolate linearly between the sorted values.
+// Called by vtkSMPTools with a range of points of the slab.
+struct enlilEnsembleStatistics
+{
+    const float* values;
+    vtkIdType numPoints;
+    int numMembers;
+
+    const double* percentiles;
+    int numPercentiles;
+
+    float* mean;
+    float* stdDev;
+    float* minimum;
+    float* maximum;
+    float** percentile;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        std::vector<float> sorted(this->numMembers);
+
+        for(vtkIdType p = begin; p < end; p++)
+        {
+            double average = 0;
+            double M2 = 0;
+            float low = this->values[p];
+            float high = low;
+
+            for(int m = 0; m < this->numMembers; m++)
+            {
+                const float value = this->values[m*this->numPoints + p];
+                sorted[m] = value;
+
+                const double delta = value - average;
+                average += delta/(m+1);
+                M2 += delta*(value - average);
+
+                low = std::min(low, value);
+                high = std::max(high, value);
+            }
+
+            //sample standard deviation (the members are a sample of possible outcomes)
+            this->mean[p] = static_cast<float>(average);
+            this->stdDev[p] = (this->numMembers > 1)
+                    ? static_cast<float>(sqrt(M2/(this->numMembers-1))) : 0.0f;
+            this->minimum[p] = low;
+            this->maximum[p] = high;
+
+            if(this->numPercentiles == 0)
+            {
+                continue;
+            }
+
+            std::sort(sorted.begin(), sorted.end());
+            for(int q = 0; q < this->numPercentiles; q++)
+            {
+                const double rank = this->percentiles[q]/100.0*(this->numMembers-1);
+                const int lower = static_cast<int>(rank);
+                const int upper = std::min(lower+1, this->numMembers-1);
+                const double fraction = rank - lower;
+
+                this->percentile[q][p] = static_cast<float>(
+                            sorted[lower] + fraction*(sorted[upper] - sorted[lower]));
+            }
+        }
+    }
+};
+
+//---------------------------------------------------------------------------------------------
+//all .nc files of directory, in name order (the order of the time steps)
+static std::vector<std::string> listMember(const std::string &directory)
+{
+    std::vector<std::string> files;
+
+    vtksys::Directory listing;
+    if(listing.Load(directory))
+    {
+        for(unsigned long x = 0; x < listing.GetNumberOfFiles(); x++)
+        {
+            std::string name = listing.GetFile(x);
+            if(vtksys::SystemTools::GetFilenameLastExtension(name) == ".nc")
+            {
+                files.push_back(directory + "/" + name);
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+//---------------------------------------------------------------------------------------------
+vtkEnlilEnsembleReader::vtkEnlilEnsembleReader()
+{
+    this->SetNumberOfInputPorts(0);
+    this->SetNumberOfOutputPorts(1);
+
+    this->MemoryLimit = 512;
+    this->GridScaleType = GRID_SCALE::AU;
+    this->DataUnits = 0;
+    this->Resolution = 1;
+    this->membersClean = false;
+
+    this->Percentiles.push_back(10);
+    this->Percentiles.push_back(50);
+    this->Percentiles.push_back(90);
+
+    this->PointDataArraySelection = vtkDataArraySelection::New();
+
+    this->SelectionObserver = vtkCallbackCommand::New();
+    this->SelectionObserver->SetCallback(&vtkEnlilEnsembleReader::SelectionCallback);
+    this->SelectionObserver->SetClientData(this);
+    this->PointDataArraySelection->AddObserver(vtkCommand::ModifiedEvent, this->SelectionObserver);
+}
+
+//---------------------------------------------------------------------------------------------
+vtkEnlilEnsembleReader::~vtkEnlilEnsembleReader()
+{
+    this->Members.clear();
+
+    this->PointDataArraySelection->Delete();
+    this->SelectionObserver->Delete();
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilEnsembleReader::SelectionCallback(
+        vtkObject* object,
+        unsigned long vtkNotUsed(eventid),
+        void* clientdata,
+        void* vtkNotUsed(calldata))
+{
+    static_cast<vtkEnlilEnsembleReader*>(clientdata)->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+//Methods for the member list
+
+void vtkEnlilEnsembleReader::AddMemberName(const char *name)
+{
+    this->MemberNames.push_back(name);
+    this->membersClean = false;
+    this->Modified();
+}
+
+void vtkEnlilEnsembleReader::RemoveAllMembers()
+{
+    this->MemberNames.clear();
+    this->Members.clear();
+    this->membersClean = false;
+    this->Modified();
+}
+
+unsigned int vtkEnlilEnsembleReader::GetNumberOfMembers()
+{
+    return this->MemberNames.size();
+}
+
+const char* vtkEnlilEnsembleReader::GetMemberName(unsigned int idx)
+{
+    return this->MemberNames[idx].c_str();
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilEnsembleReader::AddPercentile(double percentile)
+{
+    this->Percentiles.push_back(std::min(100.0, std::max(0.0, percentile)));
+    this->Modified();
+}
+
+void vtkEnlilEnsembleReader::RemoveAllPercentiles()
+{
+    this->Percentiles.clear();
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+//Member reader settings
+
+void vtkEnlilEnsembleReader::SetGridScaleType(int value)
+{
+    this->GridScaleType = value;
+    for(size_t m = 0; m < this->Members.size(); m++)
+    {
+        this->Members[m]->SetGridScaleType(value);
+    }
+    this->Modified();
+}
+
+void vtkEnlilEnsembleReader::SetDataUnits(int value)
+{
+    this->DataUnits = value;
+    for(size_t m = 0; m < this->Members.size(); m++)
+    {
+        this->Members[m]->SetDataUnits(value);
+    }
+    this->Modified();
+}
+
+void vtkEnlilEnsembleReader::SetResolution(int value)
+{
+    this->Resolution = std::max(1, value);
+    for(size_t m = 0; m < this->Members.size(); m++)
+    {
+        this->Members[m]->SetResolution(this->Resolution);
+    }
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+//Variable selection
+
+int vtkEnlilEnsembleReader::GetNumberOfPointArrays()
+{
+    return this->PointDataArraySelection->GetNumberOfArrays();
+}
+
+const char* vtkEnlilEnsembleReader::GetPointArrayName(int index)
+{
+    return this->PointDataArraySelection->GetArrayName(index);
+}
+
+int vtkEnlilEnsembleReader::GetPointArrayStatus(const char *name)
+{
+    return this->PointDataArraySelection->GetArraySetting(name);
+}
+
+void vtkEnlilEnsembleReader::SetPointArrayStatus(const char *name, int status)
+{
+    if(status)
+    {
+        this->PointDataArraySelection->EnableArray(name);
+    }
+    else
+    {
+        this->PointDataArraySelection->DisableArray(name);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//-- Return 0 for failure, 1 for success --//
+int vtkEnlilEnsembleReader::createMembers()
+{
+    if(this->membersClean)
+    {
+        return 1;
+    }
+
+    this->Members.clear();
+
+    for(size_t m = 0; m < this->MemberNames.size(); m++)
+    {
+        const std::string &name = this->MemberNames[m];
+
+        std::vector<std::string> files;
+        if(vtksys::SystemTools::FileIsDirectory(name))
+        {
+            files = listMember(name);
+        }
+        else
+        {
+            files.push_back(name);
+        }
+
+        if(files.empty())
+        {
+            vtkErrorMacro(<< "No ENLIL files in ensemble member " << name);
+            this->Members.clear();
+            return 0;
+        }
+
+        //every member is read once per time step, so nothing is worth caching
+        vtkSmartPointer<vtkEnlilReader> member = vtkSmartPointer<vtkEnlilReader>::New();
+        member->SetCacheSize(0);
+        member->SetPrefetch(0);
+        member->SetGridScaleType(this->GridScaleType);
+        member->SetDataUnits(this->DataUnits);
+        member->SetResolution(this->Resolution);
+
+        //points are computed from the axes instead of being stored for every slab
+        member->SetImplicitPoints(1);
+
+        for(size_t x = 0; x < files.size(); x++)
+        {
+            member->AddFileName(files[x].c_str());
+        }
+
+        this->Members.push_back(member);
+    }
+
+    this->membersClean = true;
+    return 1;
+}
+
+//---------------------------------------------------------------------------------------------
+//Selects the enabled variables on every member, or none at all to only read the grid.
+void vtkEnlilEnsembleReader::selectMemberArrays(bool grid)
+{
+    for(size_t m = 0; m < this->Members.size(); m++)
+    {
+        vtkEnlilReader* member = this->Members[m];
+
+        for(int x = 0; x < member->GetNumberOfPointArrays(); x++)
+        {
+            const char* name = member->GetPointArrayName(x);
+            int status = !grid && this->PointDataArraySelection->ArrayIsEnabled(name);
+            if(member->GetPointArrayStatus(name) != status)
+            {
+                member->SetPointArrayStatus(name, status);
+            }
+        }
+
+        for(int x = 0; x < member->GetNumberOfDerivedArrays(); x++)
+        {
+            const char* name = member->GetDerivedArrayName(x);
+            int status = !grid && this->PointDataArraySelection->ArrayIsEnabled(name);
+            if(member->GetDerivedArrayStatus(name) != status)
+            {
+                member->SetDerivedArrayStatus(name, status);
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+vtkStructuredGrid* vtkEnlilEnsembleReader::updateMember(vtkEnlilReader *member, double time, const int extent[])
+{
+    vtkStreamingDemandDrivenPipeline* executive
+            = vtkStreamingDemandDrivenPipeline::SafeDownCast(member->GetExecutive());
+
+    member->UpdateInformation();
+    executive->SetUpdateTimeStep(0, time);
+    executive->SetUpdateExtent(0, (int*)extent);
+    member->Update();
+
+    return member->GetOutput();
+}
+
+//---------------------------------------------------------------------------------------------
+//-- Return false if the member did not provide the variable --//
+bool vtkEnlilEnsembleReader::copyVariable(vtkStructuredGrid *grid, const std::string &variable, float *output)
+{
+    vtkDataArray* array = grid->GetPointData()->GetArray(variable.c_str());
+    if(array == NULL || array->GetNumberOfTuples() != grid->GetNumberOfPoints())
+    {
+        return false;
+    }
+
+    const vtkIdType numPoints = array->GetNumberOfTuples();
+    const int numComponents = array->GetNumberOfComponents();
+
+    vtkFloatArray* floats = vtkFloatArray::SafeDownCast(array);
+    if(floats != NULL && numComponents == 1)
+    {
+        std::copy(floats->GetPointer(0), floats->GetPointer(0) + numPoints, output);
+        return true;
+    }
+
+    //vectors contribute their magnitude
+    for(vtkIdType p = 0; p < numPoints; p++)
+    {
+        double sum = 0;
+        for(int c = 0; c < numComponents; c++)
+        {
+            const double value = array->GetComponent(p, c);
+            sum += value*value;
+        }
+        output[p] = static_cast<float>(numComponents == 1 ? array->GetComponent(p, 0) : sqrt(sum));
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+int vtkEnlilEnsembleReader::RequestInformation(
+        vtkInformation* request,
+        vtkInformationVector** inputVector,
+        vtkInformationVector* outputVector)
+{
+    if(this->MemberNames.empty())
+    {
+        vtkErrorMacro(<< "No ensemble members.");
+        return 0;
+    }
+
+    if(!this->createMembers())
+    {
+        return 0;
+    }
+
+    //every member must have the grid of the first
+    int wholeExtent[6];
+    vtkInformation* firstInfo = NULL;
+
+    for(size_t m = 0; m < this->Members.size(); m++)
+    {
+        this->Members[m]->UpdateInformation();
+
+        vtkInformation* memberInfo = this->Members[m]->GetOutputInformation(0);
+        int extent[6];
+        memberInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+
+        if(m == 0)
+        {
+            firstInfo = memberInfo;
+            std::copy(extent, extent+6, wholeExtent);
+        }
+        else if(!std::equal(extent, extent+6, wholeExtent))
+        {
+            vtkErrorMacro(<< "The grid of ensemble member " << this->MemberNames[m]
+                          << " does not match the grid of " << this->MemberNames[0]);
+            return 0;
+        }
+    }
+
+    //variables of the first member.  The magnitude of a vector is offered by its derived
+    // array, so the vector itself is left out.
+    if(this->PointDataArraySelection->GetNumberOfArrays() == 0)
+    {
+        vtkEnlilReader* first = this->Members[0];
+
+        std::set<std::string> magnitudes;
+        for(int x = 0; x < first->GetNumberOfDerivedArrays(); x++)
+        {
+            std::string name = first->GetDerivedArrayName(x);
+            this->DerivedNames.insert(name);
+            magnitudes.insert(vtksys::SystemTools::LowerCase(name));
+        }
+
+        for(int x = 0; x < first->GetNumberOfPointArrays(); x++)
+        {
+            std::string name = first->GetPointArrayName(x);
+            if(magnitudes.find(vtksys::SystemTools::LowerCase(name + " Magnitude")) == magnitudes.end())
+            {
+                this->PointDataArraySelection->AddArray(name.c_str());
+                this->PointDataArraySelection->DisableArray(name.c_str());
+            }
+        }
+
+        std::set<std::string>::iterator derived;
+        for(derived = this->DerivedNames.begin(); derived != this->DerivedNames.end(); ++derived)
+        {
+            this->PointDataArraySelection->AddArray(derived->c_str());
+            this->PointDataArraySelection->DisableArray(derived->c_str());
+        }
+    }
+
+    //times and extent of the first member
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+    if(firstInfo->Has(vtkStreamingDemandDrivenPipeline::TIME_STEPS()))
+    {
+        outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(),
+                     firstInfo->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS()),
+                     firstInfo->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS()));
+        outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(),
+                     firstInfo->Get(vtkStreamingDemandDrivenPipeline::TIME_RANGE()), 2);
+    }
+    else
+    {
+        outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+        outInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+    }
+
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent, 6);
+    outInfo->Set(vtkAlgorithm::CAN_PRODUCE_SUB_EXTENT(), 1);
+
+    return 1;
+}
+
+//---------------------------------------------------------------------------------------------
+int vtkEnlilEnsembleReader::RequestData(
+        vtkInformation* request,
+        vtkInformationVector** inputVector,
+        vtkInformationVector* outputVector)
+{
+    this->SetProgress(0);
+
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    vtkStructuredGrid* output = vtkStructuredGrid::GetData(outputVector, 0);
+
+    if(this->Members.empty())
+    {
+        return 0;
+    }
+
+    //the members pick their time step closest to the requested time
+    double time = 0;
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP()))
+    {
+        time = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+    }
+    else if(outInfo->Has(vtkStreamingDemandDrivenPipeline::TIME_STEPS()))
+    {
+        time = outInfo->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS())[0];
+    }
+
+    int extent[6];
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), extent);
+    if(extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+        output->SetExtent(extent);
+        return 1;
+    }
+
+    //grid (and meta-data) of the first member
+    this->selectMemberArrays(true);
+    vtkStructuredGrid* grid = this->updateMember(this->Members[0], time, extent);
+    output->ShallowCopy(grid);
+    output->SetExtent(extent);
+
+    std::vector<std::string> variables;
+    for(int x = 0; x < this->PointDataArraySelection->GetNumberOfArrays(); x++)
+    {
+        const char* name = this->PointDataArraySelection->GetArrayName(x);
+        if(this->PointDataArraySelection->ArrayIsEnabled(name))
+        {
+            variables.push_back(name);
+        }
+    }
+
+    const int numMembers = this->Members.size();
+    const int numVariables = variables.size();
+    const int numPercentiles = this->Percentiles.size();
+
+    vtkSmartPointer<vtkIntArray> size = vtkSmartPointer<vtkIntArray>::New();
+    size->SetName("Ensemble Size");
+    size->InsertNextValue(numMembers);
+    output->GetFieldData()->AddArray(size);
+
+    if(numVariables == 0)
+    {
+        this->SetProgress(1.0);
+        return 1;
+    }
+
+    //output arrays: mean, standard deviation, min, max and the percentiles of each variable
+    const vtkIdType planePoints = (vtkIdType)(extent[1]-extent[0]+1)*(extent[3]-extent[2]+1);
+    const int numPlanes = extent[5]-extent[4]+1;
+    const vtkIdType numPoints = planePoints*numPlanes;
+
+    std::vector<std::vector<float*> > results(numVariables);
+    for(int v = 0; v < numVariables; v++)
+    {
+        std::vector<std::string> names;
+        names.push_back(variables[v] + " Mean");
+        names.push_back(variables[v] + " StdDev");
+        names.push_back(variables[v] + " Min");
+        names.push_back(variables[v] + " Max");
+        for(int q = 0; q < numPercentiles; q++)
+        {
+            std::ostringstream name;
+            name << variables[v] << " P" << this->Percentiles[q];
+            names.push_back(name.str());
+        }
+
+        for(size_t x = 0; x < names.size(); x++)
+        {
+            vtkSmartPointer<vtkFloatArray> array = vtkSmartPointer<vtkFloatArray>::New();
+            array->SetName(names[x].c_str());
+            array->SetNumberOfComponents(1);
+            array->SetNumberOfTuples(numPoints);
+            output->GetPointData()->AddArray(array);
+
+            results[v].push_back(array->GetPointer(0));
+        }
+    }
+
+    //slabs of phi planes small enough for every member's values, and the slab output of the
+    //  member being read (radius, plus the native and converted variables), to fit the
+    //  memory limit
+    const double planeBytes = (double)planePoints*sizeof(float)
+            *(numMembers*numVariables + 1 + 2*numVariables);
+    const int slabPlanes = std::max(1, std::min(numPlanes,
+                                                (int)(this->MemoryLimit*1024.0*1024.0/planeBytes)));
+    const int numSlabs = (numPlanes + slabPlanes - 1)/slabPlanes;
+
+    std::vector<std::vector<float> > values(numVariables,
+                                            std::vector<float>(planePoints*slabPlanes*numMembers));
+
+    this->selectMemberArrays(false);
+
+    for(int slab = 0; slab < numSlabs; slab++)
+    {
+        int slabExtent[6];
+        std::copy(extent, extent+6, slabExtent);
+        slabExtent[4] = extent[4] + slab*slabPlanes;
+        slabExtent[5] = std::min(extent[5], slabExtent[4] + slabPlanes - 1);
+
+        const vtkIdType slabPoints = planePoints*(slabExtent[5]-slabExtent[4]+1);
+        const vtkIdType offset = planePoints*(slabExtent[4]-extent[4]);
+
+        //members one at a time: only one member's slab is read at once
+        for(int m = 0; m < numMembers; m++)
+        {
+            vtkStructuredGrid* memberGrid = this->updateMember(this->Members[m], time, slabExtent);
+
+            for(int v = 0; v < numVariables; v++)
+            {
+                if(!this->copyVariable(memberGrid, variables[v], &values[v][m*slabPoints]))
+                {
+                    vtkErrorMacro(<< "Ensemble member " << this->MemberNames[m]
+                                  << " did not provide " << variables[v]);
+                    return 0;
+                }
+            }
+
+            //the values are gathered, so the member does not need to hold on to its slab
+            memberGrid->Initialize();
+            this->Members[m]->ReleaseCurrentArrays();
+
+            this->SetProgress((double)(slab*numMembers + m + 1)/(numSlabs*numMembers));
+        }
+
+        for(int v = 0; v < numVariables; v++)
+        {
+            std::vector<float*> slabPercentiles(numPercentiles);
+            for(int q = 0; q < numPercentiles; q++)
+            {
+                slabPercentiles[q] = results[v][4+q] + offset;
+            }
+
+            enlilEnsembleStatistics statistics;
+            statistics.values = &values[v][0];
+            statistics.numPoints = slabPoints;
+            statistics.numMembers = numMembers;
+            statistics.percentiles = numPercentiles ? &this->Percentiles[0] : NULL;
+            statistics.numPercentiles = numPercentiles;
+            statistics.mean = results[v][0] + offset;
+            statistics.stdDev = results[v][1] + offset;
+            statistics.minimum = results[v][2] + offset;
+            statistics.maximum = results[v][3] + offset;
+            statistics.percentile = numPercentiles ? &slabPercentiles[0] : NULL;
+
+            vtkSMPTools::For(0, slabPoints, statistics);
+        }
+    }
+
+    this->SetProgress(1.0);
+    return 1;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilEnsembleReader::PrintSelf(ostream &os, vtkIndent indent)
+{
+    this->Superclass::PrintSelf(os, indent);
+
+    os << indent << "Members: " << this->MemberNames.size() << endl;
+    os << indent << "MemoryLimit: " << this->MemoryLimit << endl;
+}
@@ -0,0 +1,124 @@
+#ifndef vtkEnlilEnsembleReader_H
+#define vtkEnlilEnsembleReader_H
+
+#include "vtkStructuredGridAlgorithm.h"
+#include "vtkIOParallelNetCDFModule.h" // For export macro
+#include "vtkSmartPointer.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+class vtkCallbackCommand;
+class vtkDataArraySelection;
+class vtkEnlilReader;
+class vtkStructuredGrid;
+
+// Description:
+// Per-point statistics of an ensemble of ENLIL runs at one time step: mean, standard
+// deviation, minimum, maximum and percentiles of every selected variable.
+//
+// Every member (a run directory, or a single container file) is read by its own
+// vtkEnlilReader.  The output extent is processed in slabs of phi planes: each member
+// reads the slab in turn into a gather buffer, then the statistics of the slab are
+// computed and written to the output.  The slab is sized so the gather buffer stays
+// within MemoryLimit, so memory does not grow with the number of members.
+class VTKIOPARALLELNETCDF_EXPORT vtkEnlilEnsembleReader : public vtkStructuredGridAlgorithm
+{
+public:
+    static vtkEnlilEnsembleReader* New();
+
+    vtkTypeMacro(vtkEnlilEnsembleReader, vtkStructuredGridAlgorithm)
+    void PrintSelf(ostream &os, vtkIndent indent);
+
+    // Description:
+    // Ensemble members: run directories (every .nc file in it) or container files.
+    // All members must share the grid of the first one.
+    void AddMemberName(const char* name);
+    void RemoveAllMembers();
+    unsigned int GetNumberOfMembers();
+    const char* GetMemberName(unsigned int idx);
+
+    // Description:
+    // Percentiles (0-100) computed at every point, 10, 50 and 90 by default.
+    void AddPercentile(double percentile);
+    void RemoveAllPercentiles();
+
+    // Description:
+    // Maximum amount of memory (in MB) for the values of one slab of every member.
+    vtkSetMacro(MemoryLimit, int)
+    vtkGetMacro(MemoryLimit, int)
+
+    // Description:
+    // Passed on to the reader of every member.
+    void SetGridScaleType(int value);
+    vtkGetMacro(GridScaleType, int)
+
+    void SetDataUnits(int value);
+    vtkGetMacro(DataUnits, int)
+
+    void SetResolution(int value);
+    vtkGetMacro(Resolution, int)
+
+    // Description:
+    // Variables to compute statistics of: the scalar point arrays and the derived
+    // arrays of the first member.
+    int GetNumberOfPointArrays();
+    const char* GetPointArrayName(int index);
+    int  GetPointArrayStatus(const char* name);
+    void SetPointArrayStatus(const char* name, int status);
+
+protected:
+    vtkEnlilEnsembleReader();
+    ~vtkEnlilEnsembleReader();
+
+    virtual int RequestInformation(
+            vtkInformation* request,
+            vtkInformationVector** inputVector,
+            vtkInformationVector* outputVector);
+
+    virtual int RequestData(
+            vtkInformation* request,
+            vtkInformationVector** inputVector,
+            vtkInformationVector* outputVector);
+
+    static void SelectionCallback(
+            vtkObject *caller,
+            unsigned long eid,
+            void *clientdata,
+            void *calldata);
+
+    //(re)creates the member readers from MemberNames
+    int createMembers();
+
+    //selects the variables (or none) on every member
+    void selectMemberArrays(bool grid);
+
+    //reads extent of time on member, returns its output (NULL on failure)
+    vtkStructuredGrid* updateMember(vtkEnlilReader* member, double time, const int extent[6]);
+
+    //value of variable at every point of grid (magnitude for vectors) into output
+    bool copyVariable(vtkStructuredGrid* grid, const std::string &variable, float* output);
+
+    int MemoryLimit;
+    int GridScaleType;
+    int DataUnits;
+    int Resolution;
+
+    std::vector<std::string> MemberNames;
+    std::vector<double> Percentiles;
+    std::vector<vtkSmartPointer<vtkEnlilReader> > Members;
+    bool membersClean;
+
+    //variables of the first member; the derived ones are selected as derived arrays
+    vtkDataArraySelection* PointDataArraySelection;
+    std::set<std::string> DerivedNames;
+
+    vtkCallbackCommand* SelectionObserver;
+
+private:
+    vtkEnlilEnsembleReader(const vtkEnlilEnsembleReader&);  // Not implemented.
+    void operator=(const vtkEnlilEnsembleReader&);  // Not implemented.
+};
+
+#endif // vtkEnlilEnsembleReader_H
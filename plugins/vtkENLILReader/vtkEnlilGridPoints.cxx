@@ -0,0 +1,404 @@
+#include "vtkEnlilGridPoints.h"
+
+#include "vtkIdList.h"
+#include "vtkObjectFactory.h"
+#include "vtkVariant.h"
+
+vtkStandardNewMacro(vtkEnlilGridPoints)
+
+//---------------------------------------------------------------------------------------------
+vtkEnlilGridPoints::vtkEnlilGridPoints()
+{
+    this->NumberOfComponents = 3;
+    this->dimI = 0;
+    this->dimJ = 0;
+    this->TempValue = 0;
+}
+
+//---------------------------------------------------------------------------------------------
+vtkEnlilGridPoints::~vtkEnlilGridPoints()
+{
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::PrintSelf(ostream &os, vtkIndent indent)
+{
+    this->vtkEnlilGridPoints::Superclass::PrintSelf(os, indent);
+
+    os << indent << "Dimensions: " << this->radius.size() << " x " << this->sinTheta.size()
+       << " x " << this->sinPhi.size() << endl;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetAxes(const std::vector<double> &_radius,
+                                 const std::vector<double> &_sinTheta, const std::vector<double> &_cosTheta,
+                                 const std::vector<double> &_sinPhi, const std::vector<double> &_cosPhi)
+{
+    this->radius = _radius;
+    this->sinTheta = _sinTheta;
+    this->cosTheta = _cosTheta;
+    this->sinPhi = _sinPhi;
+    this->cosPhi = _cosPhi;
+
+    this->dimI = this->radius.size();
+    this->dimJ = this->sinTheta.size();
+
+    const vtkIdType numPoints = this->dimI*this->dimJ*(vtkIdType)this->sinPhi.size();
+    this->Size = this->NumberOfComponents*numPoints;
+    this->MaxId = this->Size-1;
+
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::Initialize()
+{
+    this->radius.clear();
+    this->sinTheta.clear();
+    this->cosTheta.clear();
+    this->sinPhi.clear();
+    this->cosPhi.clear();
+
+    this->dimI = 0;
+    this->dimJ = 0;
+
+    this->MaxId = -1;
+    this->Size = 0;
+    this->NumberOfComponents = 3;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::GetTuples(vtkIdList *ptIds, vtkAbstractArray *output)
+{
+    vtkDataArray *outArray = vtkDataArray::SafeDownCast(output);
+    if(!outArray)
+    {
+        vtkWarningMacro(<<"Input is not a vtkDataArray");
+        return;
+    }
+
+    const vtkIdType numTuples = ptIds->GetNumberOfIds();
+
+    outArray->SetNumberOfComponents(this->NumberOfComponents);
+    outArray->SetNumberOfTuples(numTuples);
+
+    for(vtkIdType i = 0; i < numTuples; i++)
+    {
+        this->GetTuple(ptIds->GetId(i), this->TempTuple);
+        outArray->SetTuple(i, this->TempTuple);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::GetTuples(vtkIdType p1, vtkIdType p2, vtkAbstractArray *output)
+{
+    vtkDataArray *outArray = vtkDataArray::SafeDownCast(output);
+    if(!outArray)
+    {
+        vtkWarningMacro(<<"Input is not a vtkDataArray");
+        return;
+    }
+
+    const vtkIdType numTuples = p2-p1+1;
+
+    outArray->SetNumberOfComponents(this->NumberOfComponents);
+    outArray->SetNumberOfTuples(numTuples);
+
+    for(vtkIdType i = 0; i < numTuples; i++)
+    {
+        this->GetTuple(p1+i, this->TempTuple);
+        outArray->SetTuple(i, this->TempTuple);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::Squeeze()
+{
+    // noop
+}
+
+//---------------------------------------------------------------------------------------------
+vtkArrayIterator* vtkEnlilGridPoints::NewIterator()
+{
+    vtkErrorMacro(<<"Not implemented.");
+    return NULL;
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::LookupValue(vtkVariant value)
+{
+    bool valid = true;
+    float val = value.ToFloat(&valid);
+    if(valid)
+    {
+        return this->Lookup(val, 0);
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::LookupValue(vtkVariant value, vtkIdList *ids)
+{
+    bool valid = true;
+    float val = value.ToFloat(&valid);
+    ids->Reset();
+    if(valid)
+    {
+        this->LookupTypedValue(val, ids);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+vtkVariant vtkEnlilGridPoints::GetVariantValue(vtkIdType idx)
+{
+    return vtkVariant(this->GetValue(idx));
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::ClearLookup()
+{
+    // no-op, no fast lookup implemented.
+}
+
+//---------------------------------------------------------------------------------------------
+double* vtkEnlilGridPoints::GetTuple(vtkIdType i)
+{
+    this->GetTuple(i, this->TempTuple);
+    return this->TempTuple;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::GetTuple(vtkIdType i, double *tuple)
+{
+    this->computePoint(i, tuple);
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::LookupTypedValue(float value)
+{
+    return this->Lookup(value, 0);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::LookupTypedValue(float value, vtkIdList *ids)
+{
+    ids->Reset();
+
+    vtkIdType index = 0;
+    while((index = this->Lookup(value, index)) >= 0)
+    {
+        ids->InsertNextId(index);
+        ++index;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+float vtkEnlilGridPoints::GetValue(vtkIdType idx)
+{
+    double xyz[3];
+    this->computePoint(idx / this->NumberOfComponents, xyz);
+    return static_cast<float>(xyz[idx % this->NumberOfComponents]);
+}
+
+//---------------------------------------------------------------------------------------------
+float& vtkEnlilGridPoints::GetValueReference(vtkIdType idx)
+{
+    //there is no storage to refer to
+    this->TempValue = this->GetValue(idx);
+    return this->TempValue;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::GetTupleValue(vtkIdType idx, float *t)
+{
+    double xyz[3];
+    this->computePoint(idx, xyz);
+
+    t[0] = static_cast<float>(xyz[0]);
+    t[1] = static_cast<float>(xyz[1]);
+    t[2] = static_cast<float>(xyz[2]);
+}
+
+//---------------------------------------------------------------------------------------------
+int vtkEnlilGridPoints::Allocate(vtkIdType, vtkIdType)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------------
+int vtkEnlilGridPoints::Resize(vtkIdType)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetNumberOfTuples(vtkIdType)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetTuple(vtkIdType, vtkIdType, vtkAbstractArray *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetTuple(vtkIdType, const float *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetTuple(vtkIdType, const double *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InsertTuple(vtkIdType, vtkIdType, vtkAbstractArray *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InsertTuple(vtkIdType, const float *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InsertTuple(vtkIdType, const double *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InsertTuples(vtkIdList *, vtkIdList *, vtkAbstractArray *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::InsertNextTuple(vtkIdType, vtkAbstractArray *)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::InsertNextTuple(const float *)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::InsertNextTuple(const double *)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::DeepCopy(vtkAbstractArray *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::DeepCopy(vtkDataArray *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InterpolateTuple(vtkIdType, vtkIdList *, vtkAbstractArray *, double *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InterpolateTuple(vtkIdType, vtkIdType, vtkAbstractArray *,
+                                          vtkIdType, vtkAbstractArray *, double)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetVariantValue(vtkIdType, vtkVariant)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::RemoveTuple(vtkIdType)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::RemoveFirstTuple()
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::RemoveLastTuple()
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetTupleValue(vtkIdType, const float *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InsertTupleValue(vtkIdType, const float *)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::InsertNextTupleValue(const float *)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::SetValue(vtkIdType, float)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::InsertNextValue(float)
+{
+    vtkErrorMacro(<<"Read only container.");
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilGridPoints::InsertValue(vtkIdType, float)
+{
+    vtkErrorMacro(<<"Read only container.");
+}
+
+//---------------------------------------------------------------------------------------------
+vtkIdType vtkEnlilGridPoints::Lookup(float value, vtkIdType index)
+{
+    while(index <= this->MaxId)
+    {
+        if(this->GetValue(index) == value)
+        {
+            return index;
+        }
+        ++index;
+    }
+    return -1;
+}
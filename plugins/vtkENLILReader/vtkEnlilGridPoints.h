@@ -0,0 +1,116 @@
+#ifndef vtkEnlilGridPoints_H
+#define vtkEnlilGridPoints_H
+
+#include "vtkMappedDataArray.h"
+#include "vtkTypeTemplate.h"
+
+#include <vector>
+
+// Description:
+// Read-only points array of a spherical ENLIL grid.  The grid is the tensor product
+// of the radius, theta and phi axes, so x/y/z of a point are computed on demand from
+// the (scaled) radii and the trig tables of the angles instead of being stored.
+// Holding the grid costs a few KB, and a new grid scale only replaces the radii.
+// Point ids run with r fastest and phi slowest, like the field arrays.
+class vtkEnlilGridPoints
+        : public vtkTypeTemplate<vtkEnlilGridPoints, vtkMappedDataArray<float> >
+{
+public:
+    vtkMappedDataArrayNewInstanceMacro(vtkEnlilGridPoints)
+    static vtkEnlilGridPoints *New();
+    virtual void PrintSelf(ostream &os, vtkIndent indent);
+
+    // Description:
+    // Set the axes of the grid: radii (already divided by the grid scale) and the
+    // sine/cosine of every theta and phi.
+    void SetAxes(const std::vector<double> &radius,
+                 const std::vector<double> &sinTheta, const std::vector<double> &cosTheta,
+                 const std::vector<double> &sinPhi, const std::vector<double> &cosPhi);
+
+    // Reimplemented virtuals -- see superclasses for descriptions:
+    void Initialize();
+    void GetTuples(vtkIdList *ptIds, vtkAbstractArray *output);
+    void GetTuples(vtkIdType p1, vtkIdType p2, vtkAbstractArray *output);
+    void Squeeze();
+    vtkArrayIterator *NewIterator();
+    vtkIdType LookupValue(vtkVariant value);
+    void LookupValue(vtkVariant value, vtkIdList *ids);
+    vtkVariant GetVariantValue(vtkIdType idx);
+    void ClearLookup();
+    double* GetTuple(vtkIdType i);
+    void GetTuple(vtkIdType i, double *tuple);
+    vtkIdType LookupTypedValue(float value);
+    void LookupTypedValue(float value, vtkIdList *ids);
+    float GetValue(vtkIdType idx);
+    float& GetValueReference(vtkIdType idx);
+    void GetTupleValue(vtkIdType idx, float *t);
+
+    // Description:
+    // This container is read only -- these methods do nothing but print an error.
+    int Allocate(vtkIdType sz, vtkIdType ext);
+    int Resize(vtkIdType numTuples);
+    void SetNumberOfTuples(vtkIdType number);
+    void SetTuple(vtkIdType i, vtkIdType j, vtkAbstractArray *source);
+    void SetTuple(vtkIdType i, const float *source);
+    void SetTuple(vtkIdType i, const double *source);
+    void InsertTuple(vtkIdType i, vtkIdType j, vtkAbstractArray *source);
+    void InsertTuple(vtkIdType i, const float *source);
+    void InsertTuple(vtkIdType i, const double *source);
+    void InsertTuples(vtkIdList *dstIds, vtkIdList *srcIds, vtkAbstractArray *source);
+    vtkIdType InsertNextTuple(vtkIdType j, vtkAbstractArray *source);
+    vtkIdType InsertNextTuple(const float *source);
+    vtkIdType InsertNextTuple(const double *source);
+    void DeepCopy(vtkAbstractArray *aa);
+    void DeepCopy(vtkDataArray *da);
+    void InterpolateTuple(vtkIdType i, vtkIdList *ptIndices,
+                          vtkAbstractArray* source, double* weights);
+    void InterpolateTuple(vtkIdType i, vtkIdType id1, vtkAbstractArray *source1,
+                          vtkIdType id2, vtkAbstractArray *source2, double t);
+    void SetVariantValue(vtkIdType idx, vtkVariant value);
+    void RemoveTuple(vtkIdType id);
+    void RemoveFirstTuple();
+    void RemoveLastTuple();
+    void SetTupleValue(vtkIdType i, const float *t);
+    void InsertTupleValue(vtkIdType i, const float *t);
+    vtkIdType InsertNextTupleValue(const float *t);
+    void SetValue(vtkIdType idx, float value);
+    vtkIdType InsertNextValue(float v);
+    void InsertValue(vtkIdType idx, float v);
+
+protected:
+    vtkEnlilGridPoints();
+    ~vtkEnlilGridPoints();
+
+    //x/y/z of point id
+    inline void computePoint(vtkIdType id, double xyz[3]) const
+    {
+        const vtkIdType i = id % this->dimI;
+        const vtkIdType j = (id / this->dimI) % this->dimJ;
+        const vtkIdType k = id / (this->dimI*this->dimJ);
+
+        const double r = this->radius[i];
+        xyz[0] = r*this->sinTheta[j]*this->cosPhi[k];
+        xyz[1] = r*this->sinTheta[j]*this->sinPhi[k];
+        xyz[2] = r*this->cosTheta[j];
+    }
+
+    std::vector<double> radius;
+    std::vector<double> sinTheta;
+    std::vector<double> cosTheta;
+    std::vector<double> sinPhi;
+    std::vector<double> cosPhi;
+
+    vtkIdType dimI;
+    vtkIdType dimJ;
+
+private:
+    vtkEnlilGridPoints(const vtkEnlilGridPoints &);  // Not implemented.
+    void operator=(const vtkEnlilGridPoints &);      // Not implemented.
+
+    vtkIdType Lookup(float value, vtkIdType startIndex);
+
+    double TempTuple[3];
+    float TempValue;
+};
+
+#endif // vtkEnlilGridPoints_H
@@ -0,0 +1,148 @@
+#include "vtkEnlilPointTimeSeries.h"
+#include "vtkEnlilReader.h"
+
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkObjectFactory.h"
+#include "vtkTable.h"
+
+vtkStandardNewMacro(vtkEnlilPointTimeSeries)
+
+//---------------------------------------------------------------------------------------------
+vtkEnlilPointTimeSeries::vtkEnlilPointTimeSeries()
+{
+    this->SetNumberOfInputPorts(0);
+    this->SetNumberOfOutputPorts(1);
+
+    //every file is visited once, so there is nothing to cache or prefetch
+    this->Reader = vtkSmartPointer<vtkEnlilReader>::New();
+    this->Reader->SetCacheSize(0);
+    this->Reader->SetPrefetch(0);
+}
+
+//---------------------------------------------------------------------------------------------
+vtkEnlilPointTimeSeries::~vtkEnlilPointTimeSeries()
+{
+}
+
+//---------------------------------------------------------------------------------------------
+//Methods for the file series and the locations
+
+void vtkEnlilPointTimeSeries::AddFileName(const char *fname)
+{
+    this->Reader->AddFileName(fname);
+    this->Modified();
+}
+
+void vtkEnlilPointTimeSeries::RemoveAllFileNames()
+{
+    this->Reader->RemoveAllFileNames();
+    this->Modified();
+}
+
+void vtkEnlilPointTimeSeries::AddLocation(double r, double theta, double phi)
+{
+    this->Locations.push_back(r);
+    this->Locations.push_back(theta);
+    this->Locations.push_back(phi);
+    this->Modified();
+}
+
+void vtkEnlilPointTimeSeries::RemoveAllLocations()
+{
+    this->Locations.clear();
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+//Reader settings
+
+void vtkEnlilPointTimeSeries::SetGridScaleType(int value)
+{
+    this->Reader->SetGridScaleType(value);
+    this->Modified();
+}
+
+int vtkEnlilPointTimeSeries::GetGridScaleType()
+{
+    return this->Reader->GetGridScaleType();
+}
+
+void vtkEnlilPointTimeSeries::SetDataUnits(int value)
+{
+    this->Reader->SetDataUnits(value);
+    this->Modified();
+}
+
+int vtkEnlilPointTimeSeries::GetDataUnits()
+{
+    return this->Reader->GetDataUnits();
+}
+
+//---------------------------------------------------------------------------------------------
+//Array selection (that of the reader)
+
+int vtkEnlilPointTimeSeries::GetNumberOfPointArrays()
+{
+    return this->Reader->GetNumberOfPointArrays();
+}
+
+const char* vtkEnlilPointTimeSeries::GetPointArrayName(int index)
+{
+    return this->Reader->GetPointArrayName(index);
+}
+
+int vtkEnlilPointTimeSeries::GetPointArrayStatus(const char *name)
+{
+    return this->Reader->GetPointArrayStatus(name);
+}
+
+void vtkEnlilPointTimeSeries::SetPointArrayStatus(const char *name, int status)
+{
+    this->Reader->SetPointArrayStatus(name, status);
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+int vtkEnlilPointTimeSeries::RequestInformation(
+        vtkInformation* request,
+        vtkInformationVector** inputVector,
+        vtkInformationVector* outputVector)
+{
+    if(this->Reader->GetNumberOfFileNames() == 0)
+    {
+        vtkErrorMacro(<< "No files to read.");
+        return 0;
+    }
+
+    //times and array names of the run; the table itself does not depend on time
+    this->Reader->UpdateInformation();
+
+    return 1;
+}
+
+//---------------------------------------------------------------------------------------------
+int vtkEnlilPointTimeSeries::RequestData(
+        vtkInformation* request,
+        vtkInformationVector** inputVector,
+        vtkInformationVector* outputVector)
+{
+    vtkTable* output = vtkTable::GetData(outputVector, 0);
+
+    if(this->Locations.empty())
+    {
+        vtkErrorMacro(<< "No locations to sample.");
+        return 0;
+    }
+
+    this->Reader->UpdateInformation();
+    return this->Reader->ExtractPointTimeSeries(this->Locations, output);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilPointTimeSeries::PrintSelf(ostream &os, vtkIndent indent)
+{
+    this->Superclass::PrintSelf(os, indent);
+
+    os << indent << "Locations: " << this->Locations.size()/3 << endl;
+}
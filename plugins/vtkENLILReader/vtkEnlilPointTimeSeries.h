@@ -0,0 +1,73 @@
+#ifndef vtkEnlilPointTimeSeries_H
+#define vtkEnlilPointTimeSeries_H
+
+#include "vtkTableAlgorithm.h"
+#include "vtkIOParallelNetCDFModule.h" // For export macro
+#include "vtkSmartPointer.h"
+
+#include <vector>
+
+class vtkEnlilReader;
+
+// Description:
+// Time series of ENLIL variables at a few locations over every file of a run, for
+// comparison with spacecraft data.  The files are read by an internal vtkEnlilReader
+// (see vtkEnlilReader::ExtractPointTimeSeries), which only reads the grid points
+// around each location, so no volume is ever loaded.
+class VTKIOPARALLELNETCDF_EXPORT vtkEnlilPointTimeSeries : public vtkTableAlgorithm
+{
+public:
+    static vtkEnlilPointTimeSeries* New();
+
+    vtkTypeMacro(vtkEnlilPointTimeSeries, vtkTableAlgorithm)
+    void PrintSelf(ostream &os, vtkIndent indent);
+
+    // Description:
+    // The files of the run.
+    void AddFileName(const char* fname);
+    void RemoveAllFileNames();
+
+    // Description:
+    // Locations to sample: r (in units of the grid scale), colatitude and longitude
+    // (degrees).
+    void AddLocation(double r, double theta, double phi);
+    void RemoveAllLocations();
+
+    // Description:
+    // Passed on to the reader.
+    void SetGridScaleType(int value);
+    int GetGridScaleType();
+
+    void SetDataUnits(int value);
+    int GetDataUnits();
+
+    // Description:
+    // Arrays to sample (the point arrays of the reader).
+    int GetNumberOfPointArrays();
+    const char* GetPointArrayName(int index);
+    int  GetPointArrayStatus(const char* name);
+    void SetPointArrayStatus(const char* name, int status);
+
+protected:
+    vtkEnlilPointTimeSeries();
+    ~vtkEnlilPointTimeSeries();
+
+    virtual int RequestInformation(
+            vtkInformation* request,
+            vtkInformationVector** inputVector,
+            vtkInformationVector* outputVector);
+
+    virtual int RequestData(
+            vtkInformation* request,
+            vtkInformationVector** inputVector,
+            vtkInformationVector* outputVector);
+
+    vtkSmartPointer<vtkEnlilReader> Reader;
+    std::vector<double> Locations;
+
+private:
+    vtkEnlilPointTimeSeries(const vtkEnlilPointTimeSeries&);  // Not implemented.
+    void operator=(const vtkEnlilPointTimeSeries&);  // Not implemented.
+};
+
+#endif // vtkEnlilPointTimeSeries_H
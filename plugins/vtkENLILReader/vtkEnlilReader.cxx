@@ -1,10 +1,12 @@
 #include "vtkEnlilReader.h"
+#include "vtkEnlilGridPoints.h"
 
 #include "vtkCallbackCommand.h"
 #include "vtkCell.h"
 #include "vtkCellData.h"
 #include "vtkCellType.h"
 #include "vtkDataArraySelection.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkFloatArray.h"
 #include "vtkTable.h"
@@ -15,9 +17,12 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkCellArray.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkExtentTranslator.h"
 
 #include "vtkStringArray.h"
 #include "vtkFloatArray.h"
@@ -33,30 +38,869 @@
 #include <iostream>
 
 #include "vtkMultiProcessController.h"
+#include "vtkSMPTools.h"
 #include "vtkToolkits.h"
 
 #include "vtk_netcdfcpp.h"
+#include "vtk_netcdf.h"
+#include <algorithm>
 #include <iostream>
+#include <string.h>
 
 
 #include "DateTime.h"
-//#include "cxform.h"
+#include "enlilContainer.h"
+#include "readerMappedFile.h"
+#include "readerNc3Header.h"
+#include "readerTimeIndex.h"
 #include "readerCache.h"
+#include "readerFilePool.h"
+#include "readerCacheManager.h"
+
+extern "C"
+{
+#include "cxform.h"
+}
 #include "vtkNew.h"
 #include <QString>
+#include <QThread>
 vtkStandardNewMacro(vtkEnlilReader)
 
+//number of points read (and converted) per chunk of phi planes
+#define ENLIL_CHUNK_POINTS (1 << 20)
+
+
+//---------------------------------------------------------------
+//    Threaded kernels
+//---------------------------------------------------------------
+
+//converts spherical vector components (r, theta, phi) into cartesian
+// components using per-theta and per-phi trig tables.  Called by
+// vtkSMPTools with a range of phi (k) planes.
+struct enlilSphericalToCartesian
+{
+    const float* R;
+    const float* T;
+    const float* P;
+
+    const double* sinTheta;
+    const double* cosTheta;
+    const double* sinPhi;
+    const double* cosPhi;
+
+    vtkIdType dimI;
+    vtkIdType dimJ;
+    double scale;
+
+    float* output;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        for(vtkIdType k = begin; k < end; k++)
+        {
+            const double sp = this->sinPhi[k];
+            const double cp = this->cosPhi[k];
+
+            for(vtkIdType j = 0; j < this->dimJ; j++)
+            {
+                const double st = this->sinTheta[j];
+                const double ct = this->cosTheta[j];
+
+                //unit vectors (scaled to output units)
+                const double rx = this->scale*st*cp, ry = this->scale*st*sp, rz = this->scale*ct;
+                const double tx = this->scale*ct*cp, ty = this->scale*ct*sp, tz = -this->scale*st;
+                const double px = -this->scale*sp,   py = this->scale*cp;
+
+                const vtkIdType loc = (k*this->dimJ + j)*this->dimI;
+                const float* r = this->R + loc;
+                const float* t = this->T + loc;
+                const float* p = this->P + loc;
+                float* xyz = this->output + 3*loc;
+
+                for(vtkIdType i = 0; i < this->dimI; i++)
+                {
+                    xyz[3*i]   = static_cast<float>(r[i]*rx + t[i]*tx + p[i]*px);
+                    xyz[3*i+1] = static_cast<float>(r[i]*ry + t[i]*ty + p[i]*py);
+                    xyz[3*i+2] = static_cast<float>(r[i]*rz + t[i]*tz);
+                }
+            }
+        }
+    }
+};
+
+
+//converts native values into the selected units: multiplies them by factor, and by
+// radius^2 as well for the SWPC density normalization (radius NULL otherwise).
+// input and output may be the same array.  Called by vtkSMPTools with a range of points.
+struct enlilUnitConversion
+{
+    const float* input;
+    float* output;
+    const float* radius;
+    int numComponents;
+    double factor;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        for(vtkIdType x = begin; x < end; x++)
+        {
+            double scale = this->factor;
+            if(this->radius != NULL)
+            {
+                scale *= (double)this->radius[x]*this->radius[x];
+            }
+
+            for(int c = 0; c < this->numComponents; c++)
+            {
+                const vtkIdType v = x*this->numComponents + c;
+                this->output[v] = static_cast<float>(this->input[v]*scale);
+            }
+        }
+    }
+};
+
+//bodies placed on the MetaData port, by their position in GSE (km): the Earth, and the
+// L1 point where the upstream solar wind monitors (ACE, SOHO, DSCOVR) sit
+static const int enlilNumberOfArtifacts = 2;
+static const char* enlilArtifactNames[enlilNumberOfArtifacts] = { "Earth", "L1" };
+static const double enlilArtifactGSE[enlilNumberOfArtifacts][3] = { {0.0, 0.0, 0.0},
+                                                                     {1.5e6, 0.0, 0.0} };
+
+//linear blend of two time steps: output = (1-weight)*earlier + weight*later.
+// Called by vtkSMPTools with a range of values.
+struct enlilTemporalBlend
+{
+    const float* earlier;
+    const float* later;
+    float* output;
+    double weight;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        const double w0 = 1.0 - this->weight;
+
+        for(vtkIdType x = begin; x < end; x++)
+        {
+            this->output[x] = static_cast<float>(w0*this->earlier[x] + this->weight*this->later[x]);
+        }
+    }
+};
+
+//fills points and radius of the spherical grid from per-axis tables.  Without points
+// (implicit grid) only the radius is filled.
+// Called by vtkSMPTools with a range of phi (k) planes.
+struct enlilGridBuilder
+{
+    const double* R;   //already divided by the grid scale
+
+    const double* sinTheta;
+    const double* cosTheta;
+    const double* sinPhi;
+    const double* cosPhi;
+
+    vtkIdType dimI;
+    vtkIdType dimJ;
+
+    float* points;
+    float* radius;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        for(vtkIdType k = begin; k < end; k++)
+        {
+            for(vtkIdType j = 0; j < this->dimJ; j++)
+            {
+                const double ax = this->sinTheta[j]*this->cosPhi[k];
+                const double ay = this->sinTheta[j]*this->sinPhi[k];
+                const double az = this->cosTheta[j];
+
+                const vtkIdType loc = (k*this->dimJ + j)*this->dimI;
+                float* rad = this->radius + loc;
+
+                if(this->points != NULL)
+                {
+                    float* xyz = this->points + 3*loc;
+
+                    for(vtkIdType i = 0; i < this->dimI; i++)
+                    {
+                        xyz[3*i]   = static_cast<float>(this->R[i]*ax);
+                        xyz[3*i+1] = static_cast<float>(this->R[i]*ay);
+                        xyz[3*i+2] = static_cast<float>(this->R[i]*az);
+                    }
+                }
+
+                for(vtkIdType i = 0; i < this->dimI; i++)
+                {
+                    rad[i] = static_cast<float>(this->R[i]);
+                }
+            }
+        }
+    }
+};
+
+
+//byte swapping of big-endian (NetCDF classic) values to the host
+static inline float enlilBigEndianFloat(const unsigned char* data)
+{
+    unsigned int value;
+    memcpy(&value, data, 4);
+#ifndef VTK_WORDS_BIGENDIAN
+#if defined(__GNUC__)
+    value = __builtin_bswap32(value);
+#else
+    value = (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+#endif
+#endif
+    float result;
+    memcpy(&result, &value, 4);
+    return result;
+}
+
+static inline double enlilBigEndianDouble(const unsigned char* data)
+{
+    unsigned long long value;
+    memcpy(&value, data, 8);
+#ifndef VTK_WORDS_BIGENDIAN
+#if defined(__GNUC__)
+    value = __builtin_bswap64(value);
+#else
+    unsigned long long swapped = 0;
+    for(int b = 0; b < 8; b++)
+    {
+        swapped = (swapped << 8) | ((value >> (8*b)) & 0xff);
+    }
+    value = swapped;
+#endif
+#endif
+    double result;
+    memcpy(&result, &value, 8);
+    return result;
+}
+
+//converts a (strided) block of a memory mapped classic variable, stored (phi, theta, r)
+// as big-endian float or double, into native floats.  At full resolution every row of
+// r is contiguous, so the inner loop is a plain byte swap the compiler vectorizes.
+// Called by vtkSMPTools with a range of output phi (k) planes.
+struct enlilBigEndianToFloat
+{
+    const unsigned char* source;    //first value of the variable
+    bool isDouble;
+
+    vtkIdType fileDimI;             //r and theta sizes in the file
+    vtkIdType fileDimJ;
+
+    vtkIdType startI;               //file index of the first output value
+    vtkIdType startJ;
+    vtkIdType startK;
+    vtkIdType stride;
+
+    vtkIdType dimI;                 //output sizes
+    vtkIdType dimJ;
+
+    float* output;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        const int size = this->isDouble ? 8 : 4;
+        const vtkIdType step = this->stride*size;
+
+        for(vtkIdType k = begin; k < end; k++)
+        {
+            const vtkIdType fileK = this->startK + k*this->stride;
+
+            for(vtkIdType j = 0; j < this->dimJ; j++)
+            {
+                const vtkIdType fileJ = this->startJ + j*this->stride;
+                const unsigned char* row = this->source
+                        + ((fileK*this->fileDimJ + fileJ)*this->fileDimI + this->startI)*size;
+                float* out = this->output + (k*this->dimJ + j)*this->dimI;
+
+                if(this->isDouble)
+                {
+                    for(vtkIdType i = 0; i < this->dimI; i++)
+                    {
+                        out[i] = static_cast<float>(enlilBigEndianDouble(row + i*step));
+                    }
+                }
+                else if(this->stride == 1)
+                {
+                    for(vtkIdType i = 0; i < this->dimI; i++)
+                    {
+                        out[i] = enlilBigEndianFloat(row + 4*i);
+                    }
+                }
+                else
+                {
+                    for(vtkIdType i = 0; i < this->dimI; i++)
+                    {
+                        out[i] = enlilBigEndianFloat(row + i*step);
+                    }
+                }
+            }
+        }
+    }
+};
+
+//computes the selected derived quantities (in native units) of a chunk of phi planes
+// from the native variables, then converts that plane of any vector inputs loaded in
+// the same pass to cartesian, so each plane is only brought into cache once.  Magnitudes
+// are taken in spherical components, or in the cartesian components of a vector that is
+// already loaded (the rotation to cartesian does not change them).
+// Called by vtkSMPTools with a range of phi (k) planes of the chunk.
+struct enlilDerivedQuantities
+{
+    //native inputs of the chunk (NULL when not needed)
+    const float* D;
+    const float* T;
+    const float* B[3];
+    const float* V[3];
+    const float* radius;
+
+    //distance between the values of a point in B and V: 1 for planes of spherical
+    // components, 3 for the cartesian tuples of a loaded vector
+    int bStride;
+    int vStride;
+
+    vtkIdType planeSize;
+
+    //selected outputs of the chunk (NULL when not selected)
+    float* output[DERIVED::NUMBER];
+
+    //input arrays loaded in the same pass (NULL when not loaded)
+    enlilSphericalToCartesian* bField;
+    enlilSphericalToCartesian* velocity;
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        const double betaFactor = 2.0*UNITS::mu0*UNITS::kb/UNITS::emu;
+        const double densityFactor = 1.0/(UNITS::emu*UNITS::km2cm);
+
+        for(vtkIdType k = begin; k < end; k++)
+        {
+            const vtkIdType first = k*this->planeSize;
+            const vtkIdType last = first + this->planeSize;
+
+            for(vtkIdType p = first; p < last; p++)
+            {
+                double b2 = 0.0;
+                double v2 = 0.0;
+
+                if(this->B[0] != NULL)
+                {
+                    const vtkIdType b = p*this->bStride;
+                    b2 = (double)this->B[0][b]*this->B[0][b] + (double)this->B[1][b]*this->B[1][b]
+                            + (double)this->B[2][b]*this->B[2][b];
+                }
+
+                if(this->V[0] != NULL)
+                {
+                    const vtkIdType v = p*this->vStride;
+                    v2 = (double)this->V[0][v]*this->V[0][v] + (double)this->V[1][v]*this->V[1][v]
+                            + (double)this->V[2][v]*this->V[2][v];
+                }
+
+                if(this->output[DERIVED::BMAG] != NULL)
+                {
+                    this->output[DERIVED::BMAG][p] = static_cast<float>(sqrt(b2));
+                }
+
+                if(this->output[DERIVED::VMAG] != NULL)
+                {
+                    this->output[DERIVED::VMAG][p] = static_cast<float>(sqrt(v2));
+                }
+
+                if(this->output[DERIVED::PDYN] != NULL)
+                {
+                    this->output[DERIVED::PDYN][p] = static_cast<float>(this->D[p]*v2);
+                }
+
+                if(this->output[DERIVED::BETA] != NULL)
+                {
+                    //no field, no magnetic pressure: report 0 rather than inf
+                    this->output[DERIVED::BETA][p] = (b2 > 0.0) ?
+                                static_cast<float>(betaFactor*this->D[p]*this->T[p]/b2) : 0.0f;
+                }
+
+                if(this->output[DERIVED::NR2] != NULL)
+                {
+                    this->output[DERIVED::NR2][p] = static_cast<float>(densityFactor*this->D[p]
+                                                                       *this->radius[p]*this->radius[p]);
+                }
+            }
+
+            //the inputs of this plane are no longer needed in native units
+            if(this->bField != NULL)
+            {
+                (*this->bField)(k, k+1);
+            }
+
+            if(this->velocity != NULL)
+            {
+                (*this->velocity)(k, k+1);
+            }
+        }
+    }
+};
+
+//reads the time information of a range of files in the series.  Unchanged files are
+// taken from the sidecar index; classic files are parsed without the NetCDF library so
+// the threads do not have to wait on each other.  Anything else (NetCDF-4) goes through
+// the library, one file at a time.
+// Called by vtkSMPTools with a range of file indices.
+struct enlilTimeScanner
+{
+    const std::vector<std::string>* fileNames;
+    const readerTimeIndex* index;
+
+    std::vector<readerTimeIndex::entry>* entries;
+    std::vector<char>* status;      //0 = failed, 1 = from index, 2 = scanned
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        for(vtkIdType x = begin; x < end; x++)
+        {
+            const std::string &fileName = (*this->fileNames)[x];
+            readerTimeIndex::entry &item = (*this->entries)[x];
+
+            if(this->index->lookup(fileName, item))
+            {
+                (*this->status)[x] = 1;
+                continue;
+            }
+
+            (*this->status)[x] = 0;
+            item.fileName = fileName;
+            if(!readerTimeIndex::getFileStamp(fileName, item.fileSize, item.modifiedTime))
+            {
+                continue;
+            }
+
+            double refMJD = 0;
+            double time = 0;
+            bool found = false;
+
+            readerNc3Header header;
+            if(header.read(fileName))
+            {
+                const readerNc3Header::attribute* mjd_start = header.getAttribute("refdate_mjd");
+                found = mjd_start != NULL && !mjd_start->values.empty()
+                        && header.readValue("TIME", 0, time);
+                if(found)
+                {
+                    refMJD = mjd_start->values[0];
+                }
+            }
+            else
+            {
+                QMutexLocker locker(&readerFilePool::libraryLock());
+
+                NcFile data(fileName.c_str());
+                NcVar* timeVar = data.is_valid() ? data.get_var("TIME") : NULL;
+                NcAtt* mjd_start = data.is_valid() ? data.get_att("refdate_mjd") : NULL;
+                found = timeVar != NULL && mjd_start != NULL;
+                if(found)
+                {
+                    refMJD = mjd_start->as_double(0);
+                    time = timeVar->as_double(0);
+                }
+                delete mjd_start;
+                data.close();
+            }
+
+            if(!found)
+            {
+                continue;
+            }
+
+            DateTime refDate(refMJD);
+            refDate.incrementSeconds(time);
+
+            item.mjd = refDate.getMJD();
+            item.physicalTime = time;
+            item.dateString = refDate.getDateTimeString();
+
+            (*this->status)[x] = 2;
+        }
+    }
+};
+
+
+//folds one time step of an array into the running temporal reduction: maximum, sum
+// (for the mean) and arrival time.  Vectors are reduced by their magnitude.  The first
+// step sets the baseline the arrival is measured against.
+// Called by vtkSMPTools with a range of points.
+struct enlilTemporalAccumulator
+{
+    const float* values;
+    int numComponents;
+    bool first;
+
+    double hours;       //time of this step after the first
+    double factor;      //arrival: value >= factor*baseline
+
+    float* maximum;
+    double* sum;
+    float* baseline;
+    float* arrival;     //NaN until the point arrives
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        for(vtkIdType p = begin; p < end; p++)
+        {
+            float value = this->values[p];
+            if(this->numComponents == 3)
+            {
+                const float* v = this->values + 3*p;
+                value = static_cast<float>(sqrt((double)v[0]*v[0] + (double)v[1]*v[1] + (double)v[2]*v[2]));
+            }
+
+            if(this->first)
+            {
+                this->maximum[p] = value;
+                this->sum[p] = value;
+                this->baseline[p] = value;
+                this->arrival[p] = vtkMath::Nan();
+                continue;
+            }
+
+            this->maximum[p] = std::max(this->maximum[p], value);
+            this->sum[p] += value;
+
+            if(this->arrival[p] != this->arrival[p] && this->baseline[p] > 0
+                    && value >= this->factor*this->baseline[p])
+            {
+                this->arrival[p] = static_cast<float>(this->hours);
+            }
+        }
+    }
+};
+
+//reads one time step of a temporal reduction while the previous one is accumulated
+class enlilReductionReader : public QThread
+{
+public:
+    vtkEnlilReader* reader;
+    double time;
+    const std::vector<std::string>* arrays;
+    std::vector<vtkSmartPointer<vtkFloatArray> >* buffers;
+    bool ok;
+
+protected:
+    virtual void run()
+    {
+        this->ok = this->reader->readReductionStep(this->time, *this->arrays, *this->buffers);
+    }
+};
+
+
+//a probe location: the file indices of the 8 grid points around it and their
+// trilinear weights, and what is needed to convert values at the location
+struct enlilProbe
+{
+    size_t i[2], j[2], k[2];
+    double wi[2], wj[2], wk[2];
+
+    double sinTheta, cosTheta, sinPhi, cosPhi;
+    double radius;      //in grid scale units
+    bool inside;
+};
+
+//an array sampled at the probes: one variable (scalar) or the r, theta and phi
+// components of a vector, and its conversion to output units
+struct enlilProbeColumn
+{
+    std::string name;
+    std::vector<std::string> variables;
+    double scale;
+    bool scaleByRadius;
+};
+
+//samples the columns at every probe, for a range of time steps.  Only the 8 values
+// around each probe are read from each file: classic files straight from a private
+// memory map, anything else through the library (one thread at a time).
+// Called by vtkSMPTools with a range of time step indices.
+struct enlilProbeSampler
+{
+    const std::vector<std::string>* files;     //per time step
+    const std::vector<int>* records;
+    const std::vector<enlilProbe>* probes;
+    const std::vector<enlilProbeColumn>* columns;
+
+    int valuesPerProbe;
+    double* output;             //[step][probe][column components]
+    std::vector<char>* status;  //per time step
+
+    //one value of variable at file index (record, k, j, i)
+    static bool mappedValue(const readerMappedFile &mapped, const readerNc3Header::variable &var,
+                            int record, size_t k, size_t j, size_t i, double &value)
+    {
+        const unsigned char* data = mapped.getData(var, record);
+        if(data == NULL || var.shape.size() != 4)
+        {
+            return false;
+        }
+
+        const unsigned long long element = (k*var.shape[2] + j)*var.shape[3] + i;
+        if(var.type == readerNc3Header::NC3_FLOAT)
+        {
+            value = enlilBigEndianFloat(data + 4*element);
+        }
+        else if(var.type == readerNc3Header::NC3_DOUBLE)
+        {
+            value = enlilBigEndianDouble(data + 8*element);
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //trilinear interpolation of variable at probe (from the map, or ncid if there is none)
+    static bool sample(const readerMappedFile* mapped, int ncid, const std::string &variable,
+                       int record, const enlilProbe &probe, double &value)
+    {
+        const readerNc3Header::variable* var = NULL;
+        int varID = 0;
+
+        if(mapped != NULL)
+        {
+            var = mapped->getHeader().getVariable(variable);
+            if(var == NULL)
+            {
+                return false;
+            }
+        }
+        else if(nc_inq_varid(ncid, variable.c_str(), &varID) != NC_NOERR)
+        {
+            return false;
+        }
+
+        value = 0;
+        for(int c = 0; c < 8; c++)
+        {
+            const int a = c & 1, b = (c >> 1) & 1, d = (c >> 2) & 1;
+            const double weight = probe.wi[a]*probe.wj[b]*probe.wk[d];
+            if(weight == 0)
+            {
+                continue;
+            }
+
+            double corner = 0;
+            if(mapped != NULL)
+            {
+                if(!mappedValue(*mapped, *var, record, probe.k[d], probe.j[b], probe.i[a], corner))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                size_t index[4] = {(size_t)record, probe.k[d], probe.j[b], probe.i[a]};
+                if(nc_get_var1_double(ncid, varID, index, &corner) != NC_NOERR)
+                {
+                    return false;
+                }
+            }
+
+            value += weight*corner;
+        }
+
+        return true;
+    }
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        const size_t numProbes = this->probes->size();
+
+        for(vtkIdType step = begin; step < end; step++)
+        {
+            const std::string &fileName = (*this->files)[step];
+            const int record = (*this->records)[step];
+            double* values = this->output + step*numProbes*this->valuesPerProbe;
+
+            readerMappedFile mapped;
+            bool isMapped = mapped.open(fileName);
+
+            //the library is not thread safe, so without a map the whole step is serialized
+            QMutex* lock = isMapped ? NULL : &readerFilePool::libraryLock();
+            if(lock != NULL)
+            {
+                lock->lock();
+            }
+
+            int ncid = -1;
+            bool ok = isMapped || nc_open(fileName.c_str(), NC_NOWRITE, &ncid) == NC_NOERR;
+
+            for(size_t p = 0; ok && p < numProbes; p++)
+            {
+                const enlilProbe &probe = (*this->probes)[p];
+                double* out = values + p*this->valuesPerProbe;
+
+                for(size_t c = 0; ok && c < this->columns->size(); c++)
+                {
+                    const enlilProbeColumn &column = (*this->columns)[c];
+                    const int numComponents = column.variables.size();
+
+                    if(!probe.inside)
+                    {
+                        for(int x = 0; x < numComponents; x++)
+                        {
+                            out[x] = vtkMath::Nan();
+                        }
+                        out += numComponents;
+                        continue;
+                    }
+
+                    double v[3] = {0, 0, 0};
+                    for(int x = 0; ok && x < numComponents; x++)
+                    {
+                        ok = sample(isMapped ? &mapped : NULL, ncid, column.variables[x], record, probe, v[x]);
+                    }
+
+                    if(numComponents == 3)
+                    {
+                        //spherical to cartesian at the probe
+                        const double st = probe.sinTheta, ct = probe.cosTheta;
+                        const double sp = probe.sinPhi, cp = probe.cosPhi;
+
+                        out[0] = column.scale*(v[0]*st*cp + v[1]*ct*cp - v[2]*sp);
+                        out[1] = column.scale*(v[0]*st*sp + v[1]*ct*sp + v[2]*cp);
+                        out[2] = column.scale*(v[0]*ct - v[1]*st);
+                    }
+                    else
+                    {
+                        out[0] = column.scale*v[0];
+                        if(column.scaleByRadius)
+                        {
+                            out[0] *= probe.radius*probe.radius;
+                        }
+                    }
+
+                    out += numComponents;
+                }
+            }
+
+            if(ncid >= 0)
+            {
+                nc_close(ncid);
+            }
+
+            if(lock != NULL)
+            {
+                lock->unlock();
+            }
+
+            (*this->status)[step] = ok;
+            if(!ok)
+            {
+                std::fill(values, values + numProbes*this->valuesPerProbe, vtkMath::Nan());
+            }
+        }
+    }
+};
+
+//finds the two points of axis around x and their linear weights.  A periodic axis
+// (phi) wraps from its last point back to the first.  Returns false if x is outside of
+// a non-periodic axis.
+static bool enlilBracket(const std::vector<double> &axis, double x, bool periodic, size_t index[2], double weight[2])
+{
+    const size_t n = axis.size();
+
+    index[0] = index[1] = 0;
+    weight[0] = 1;
+    weight[1] = 0;
+
+    if(n < 2)
+    {
+        return n == 1;
+    }
+
+    if(periodic)
+    {
+        const double period = 2*vtkMath::Pi();
+        x = axis[0] + fmod(fmod(x - axis[0], period) + period, period);
+
+        if(x > axis[n-1])
+        {
+            index[0] = n-1;
+            index[1] = 0;
+            weight[1] = (x - axis[n-1])/(axis[0] + period - axis[n-1]);
+            weight[0] = 1 - weight[1];
+            return true;
+        }
+    }
+    else if(x < axis[0] || x > axis[n-1])
+    {
+        return false;
+    }
+
+    size_t upper = std::upper_bound(axis.begin(), axis.end(), x) - axis.begin();
+    upper = std::max((size_t)1, std::min(upper, n-1));
+
+    index[0] = upper-1;
+    index[1] = upper;
+    weight[1] = (x - axis[upper-1])/(axis[upper] - axis[upper-1]);
+    weight[0] = 1 - weight[1];
+    return true;
+}
+
+
+//builds a single value field data array named name from a NetCDF attribute.
+// Only text, int and double attributes are converted; NULL for anything else.
+static vtkAbstractArray* enlilAttributeToArray(NcAtt* attribute, const std::string &name)
+{
+    switch(attribute->type())
+    {
+    case ncChar:
+    {
+        char* value = attribute->as_string(0);
+
+        vtkStringArray* MetaString = vtkStringArray::New();
+        MetaString->SetName(name.c_str());
+        MetaString->SetNumberOfComponents(1);
+        MetaString->InsertNextValue(value);
+
+        delete [] value;
+        return MetaString;
+    }
+
+    case ncInt:
+    {
+        vtkIntArray* MetaInt = vtkIntArray::New();
+        MetaInt->SetName(name.c_str());
+        MetaInt->SetNumberOfComponents(1);
+        MetaInt->InsertNextValue(attribute->as_int(0));
+        return MetaInt;
+    }
+
+    case ncDouble:
+    {
+        vtkFloatArray* MetaDouble = vtkFloatArray::New();
+        MetaDouble->SetName(name.c_str());
+        MetaDouble->SetNumberOfComponents(1);
+        MetaDouble->InsertNextValue(attribute->as_double(0));
+        return MetaDouble;
+    }
+
+    default:
+        return NULL;
+    }
+}
+
 
 //---------------------------------------------------------------
 //    Constructors and Destructors
 //---------------------------------------------------------------
 vtkEnlilReader::vtkEnlilReader()
+    : ReadLock(QMutex::Recursive)
 {
     int nulExtent[6] = {0,0,0,0,0,0};
     this->FileName = NULL;
 
-    //set the number of output ports you will need
-    this->SetNumberOfOutputPorts(1);
+    //set the number of output ports you will need (the grid, and the MetaData positions)
+    this->SetNumberOfOutputPorts(2);
 
     //set the number of input ports (Default 0)
     this->SetNumberOfInputPorts(0);
@@ -67,6 +911,14 @@ vtkEnlilReader::vtkEnlilReader()
     this->PointDataArraySelection->DisableAllArrays();
     this->CellDataArraySelection->DisableAllArrays();
 
+    //derived quantities don't depend on the file, so they are known up front
+    this->DerivedDataArraySelection = vtkDataArraySelection::New();
+    for(int x = 0; x < DERIVED::NUMBER; x++)
+    {
+        this->DerivedDataArraySelection->AddArray(DERIVED::Names[x]);
+    }
+    this->DerivedDataArraySelection->DisableAllArrays();
+
     this->numberOfArrays = 0;
 
     //Configure sytem array interfaces
@@ -76,6 +928,7 @@ vtkEnlilReader::vtkEnlilReader()
     this->infoClean = false;
 
     this->timesCalulated = false;
+    this->CurrentRecord = 0;
     this->timeRange[0] = 0;
     this->timeRange[1] = 0;
 
@@ -84,22 +937,81 @@ vtkEnlilReader::vtkEnlilReader()
     this->setMyExtents(this->WholeExtent, nulExtent);
     this->setMyExtents(this->SubExtent, nulExtent);
 
+    this->setMyExtents(this->CurrentArraysExtent, nulExtent);
+    this->CurrentArraysRecord = -1;
+    this->CurrentArraysResolution = 0;
+
+    this->setMyExtents(this->BracketExtent, nulExtent);
+    this->BracketMTime = 0;
+    this->BracketCurrent = 0;
+
     this->SelectionObserver = vtkCallbackCommand::New();
     this->SelectionObserver->SetCallback(&vtkEnlilReader::SelectionCallback);
     this->SelectionObserver->SetClientData(this);
     this->PointDataArraySelection->AddObserver(vtkCommand::ModifiedEvent, this->SelectionObserver);
     this->CellDataArraySelection->AddObserver(vtkCommand::ModifiedEvent, this->SelectionObserver);
+    this->DerivedDataArraySelection->AddObserver(vtkCommand::ModifiedEvent, this->SelectionObserver);
+
+    //all array caches share one memory budget
+    this->pDensityCache.setBudget(&this->CacheBudget);
+    this->cDensityCache.setBudget(&this->CacheBudget);
+    this->temperatureCache.setBudget(&this->CacheBudget);
+    this->polarityCache.setBudget(&this->CacheBudget);
+    this->bFieldCache.setBudget(&this->CacheBudget);
+    this->velocityCache.setBudget(&this->CacheBudget);
+    for(int x = 0; x < DERIVED::NUMBER; x++)
+    {
+        this->derivedCache[x].setBudget(&this->CacheBudget);
+    }
+
+    this->CacheSize = 0;
+    this->SetCacheSize(1024);
+    this->CacheCompression = 0;
+    this->SetCacheCompression(50);
+
+    //native units, unscaled grid
+    this->DataUnits = 0;
+    this->GridScaleType = GRID_SCALE::NONE;
+    this->GridScaleBuilt = -1;
 
+    //full resolution
+    this->Resolution = 1;
+
+    //explicit x/y/z
+    this->ImplicitPoints = 0;
+
+    //one time step at a time; arrival at twice the initial value
+    this->TemporalReduction = 0;
+    this->TemporalInterpolation = 0;
+    this->ArrivalFactor = 2.0;
+
+    //whole volume; planes through Earth (at 1 AU)
+    this->OutputMode = OUTPUT_MODE::VOLUME;
+    this->MeridionalLongitude = 0.0;
+    this->SphereRadius = 1.0;
+
+    //background reading of the next time step
+    this->Prefetch = 1;
+    this->Prefetcher = new readerCacheManager(this);
+    this->lastStepIndex = -1;
+    this->lastStepStride = 0;
 
 }
 
 //---------------------------------------------------------------------------------------------
 vtkEnlilReader::~vtkEnlilReader()
 {
+    //stop the background reader before anything it uses goes away
+    delete this->Prefetcher;
+    this->Prefetcher = NULL;
+
     this->PointDataArraySelection->Delete();
     this->CellDataArraySelection->Delete();
+    this->DerivedDataArraySelection->Delete();
     this->SelectionObserver->Delete();
 
+    this->FilePool.closeAll();
+
 
 }
 
@@ -219,6 +1131,55 @@ void vtkEnlilReader::SetCellArrayStatus(const char *name, int status)
 
 }
 
+//---------------------------------------------------------------------------------------------
+/*
+ * The Number of Derived Arrays that can be computed
+ *  This is an internal function
+ */
+int vtkEnlilReader::GetNumberOfDerivedArrays()
+{
+    return this->DerivedDataArraySelection->GetNumberOfArrays();
+}
+
+//---------------------------------------------------------------------------------------------
+/*
+ *Return the NAME (characters) of the Derived array at index
+ *   This is an internal function
+ */
+const char* vtkEnlilReader::GetDerivedArrayName(int index)
+{
+    return this->DerivedDataArraySelection->GetArrayName(index);
+}
+
+//---------------------------------------------------------------------------------------------
+/*
+ *Get the status of the Derived Array of "name"
+ *   This is an internal function
+ */
+int vtkEnlilReader::GetDerivedArrayStatus(const char *name)
+{
+    return this->DerivedDataArraySelection->GetArraySetting(name);
+}
+
+//---------------------------------------------------------------------------------------------
+/*
+ *Set the status of the Derived Array of "name"
+ *   This is an internal function
+ */
+void vtkEnlilReader::SetDerivedArrayStatus(const char *name, int status)
+{
+    if(status)
+    {
+        this->DerivedDataArraySelection->EnableArray(name);
+    }
+    else
+    {
+        this->DerivedDataArraySelection->DisableArray(name);
+    }
+
+    this->Modified();
+}
+
 //---------------------------------------------------------------------------------------------
 /*
  *Disables ALL Point arrays registered in system
@@ -300,6 +1261,9 @@ int vtkEnlilReader::RequestInformation(
 {
     int status = 0;
 
+    //the prefetcher may be reading
+    QMutexLocker locker(&this->ReadLock);
+
     // Array names and extents
     vtkInformation* DataOutputInfo = outputVector->GetInformationObject(0);
     status = this->checkStatus(
@@ -307,15 +1271,24 @@ int vtkEnlilReader::RequestInformation(
                 (char*)" Array Name: Data Info Output Information");
 
     //Set the Whole Extents and Time
-    this->calculateTimeSteps();
+    if(!this->calculateTimeSteps())
+    {
+        return 0;
+    }
 
     //Setup the grid date
     this->PopulateGridData();
 
-    //get information from the first file in the list... it has to come from somewhere...
-    this->CurrentFileName = (char*) this->fileNames[0].c_str();
+    //get information from the first readable file... it has to come from somewhere...
+    this->CurrentFileName = (char*) this->time2fileMap[this->TimeSteps[0]].c_str();
     this->FileName = CurrentFileName;
 
+    //a plane output mode only offers (and reads) its plane
+    if(!this->restrictToOutputPlane())
+    {
+        return 0;
+    }
+
     if(status)
     {
         //Work Around for restore state problems
@@ -334,7 +1307,7 @@ int vtkEnlilReader::RequestInformation(
         // most likely from a data set that is a single file with no time anyway.
         // Even if it is not, how much value added is there for a single time value?
         //  This section is adapted from the ParaView vtkFileSeriesReader
-        if (this->timeRange[0] >= this->timeRange[1])
+        if (this->timeRange[0] >= this->timeRange[1] || this->TemporalReduction)
         {
             DataOutputInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
             DataOutputInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
@@ -355,12 +1328,35 @@ int vtkEnlilReader::RequestInformation(
 
         }
 
+        //the positions on the MetaData port follow every time step of the run
+        vtkInformation* MetaDataOutputInfo = outputVector->GetInformationObject(1);
+        if (this->timeRange[0] >= this->timeRange[1])
+        {
+            MetaDataOutputInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_RANGE());
+            MetaDataOutputInfo->Remove(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+        }
+        else
+        {
+            MetaDataOutputInfo->Set(
+                        vtkStreamingDemandDrivenPipeline::TIME_STEPS(),
+                        this->TimeSteps.data(),
+                        this->NumberOfTimeSteps);
+
+            MetaDataOutputInfo->Set(
+                        vtkStreamingDemandDrivenPipeline::TIME_RANGE(),
+                        this->timeRange,
+                        2);
+        }
+
         //Set Extents
         DataOutputInfo->Set(
                     vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(),
                     this->WholeExtent,
                     6);
 
+        //we can read any sub-extent, so pieces under pvserver only read their own slab
+        DataOutputInfo->Set(vtkAlgorithm::CAN_PRODUCE_SUB_EXTENT(), 1);
+
 
     }
     return 1;
@@ -380,29 +1376,218 @@ int vtkEnlilReader::RequestData(
     //need to determine the current requested file
     double requestedTimeValue = this->getRequestedTime(outputVector);
 
+    //time steps blended when interpolating
+    double earlier = 0;
+    double later = 0;
+    double weight = 0;
+    bool interpolate = !this->TemporalReduction
+            && this->getInterpolationBracket(outputVector, earlier, later, weight);
+
+    //stop prefetching anything but what we are about to read, then wait for
+    // the prefetcher to let go of the files.  Between two steps, the read ahead
+    // of the steps on either side is kept, as following frames still need it.
+    if(interpolate)
+    {
+        int index = std::lower_bound(this->TimeSteps.begin(), this->TimeSteps.end(), earlier) - this->TimeSteps.begin();
+        int last = (int)this->TimeSteps.size()-1;
+
+        this->Prefetcher->cancelOutside(this->TimeSteps[std::max(index-1, 0)],
+                                        this->TimeSteps[std::min(index+2, last)]);
+    }
+    else
+    {
+        this->Prefetcher->cancelUnless(requestedTimeValue);
+    }
+    QMutexLocker locker(&this->ReadLock);
+
     //    std::cout << "Requested Time Value in Request Data: " << requestedTimeValue << std::endl;
 
-    this->CurrentFileName = (char*)this->time2fileMap[requestedTimeValue].c_str();
-    this->CurrentPhysicalTime = this->time2physicaltimeMap[requestedTimeValue];
-    this->CurrentDateTimeString = (char*) this->time2datestringMap[requestedTimeValue].c_str();
+    this->setCurrentTimeStep(requestedTimeValue);
 
-    //hack to be fixed
-    this->FileName = this->CurrentFileName;
+    //Import the MetaData
+    this->LoadMetaData(outputVector);
+
+    //    std::cout << __FUNCTION__ <<  " Loaded MetaData" << std::endl;
+    this->SetProgress(.05);
+
+    //Import the actual Data (or the reduction of every time step)
+    if(this->TemporalReduction)
+    {
+        this->LoadTemporalReduction(outputVector);
+    }
+    else if(interpolate)
+    {
+        //blend the time steps on either side of the requested time
+        if(!this->LoadInterpolatedData(outputVector, earlier, later, weight))
+        {
+            std::cerr << "Failed to interpolate between time steps " << earlier << " and " << later << std::endl;
+            vtkStructuredGrid::GetData(outputVector, 0)->Initialize();
+            return 0;
+        }
+        this->setCurrentTimeStep(requestedTimeValue);
+
+        //the next frame needs the step after the later one
+        this->schedulePrefetch(later);
+    }
+    else
+    {
+        //the arrays of the last bracket are not needed while not interpolating
+        this->BracketArrays.clear();
+
+        this->LoadVariableData(outputVector);
+
+        //read ahead in the direction we are playing
+        this->schedulePrefetch(requestedTimeValue);
+    }
+
+    //planet and spacecraft markers, looked up from the positions table
+    this->LoadArtifacts(outputVector);
+
+    this->SetProgress(1.00);
+
+    //    std::cout << __FUNCTION__ << " Stop" << std::endl;
+    return 1;
+
+}
+
+//---------------------------------------------------------------------------------------------
+//Get the extent to read.  When the pipeline splits the whole grid into pieces (pvserver),
+// it is cut into slabs of phi planes, which is the slowest varying dimension in the
+// files, so every piece reads one contiguous block of each variable.  The slab ending at
+// the last plane includes the periodic plane (read from file plane 0).  A request for
+// anything less than the whole extent is read as it was asked for.
+// updateExtent includes ghost planes, pieceExtent does not.  Ghost planes stop at the
+// phi seam: a structured extent cannot wrap around to the planes on the other side.
+// Returns 0 if the piece is empty.
+int vtkEnlilReader::getUpdateExtent(vtkInformation* outInfo, int updateExtent[6], int pieceExtent[6], int &ghostLevels)
+{
+    int piece = 0;
+    int numPieces = 1;
+    ghostLevels = 0;
+
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER()))
+    {
+        piece = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER());
+    }
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES()))
+    {
+        numPieces = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES());
+    }
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_GHOST_LEVELS()))
+    {
+        ghostLevels = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_GHOST_LEVELS());
+    }
+
+    //a single piece, or a request for a sub-extent, reads whatever extent was asked for.
+    //  Ghost planes of a sub-extent request are the pipeline's to mark.
+    outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent);
+    if(numPieces <= 1 || !this->eq(updateExtent, this->WholeExtent))
+    {
+        this->setMyExtents(pieceExtent, updateExtent);
+        ghostLevels = 0;
+        return updateExtent[0] <= updateExtent[1] && updateExtent[2] <= updateExtent[3]
+                && updateExtent[4] <= updateExtent[5];
+    }
+
+    vtkExtentTranslator* translator = vtkExtentTranslator::New();
+
+    //a single phi plane (meridional output) is cut along theta instead
+    int splitMode = (this->WholeExtent[4] == this->WholeExtent[5])
+            ? vtkExtentTranslator::Y_SLAB_MODE : vtkExtentTranslator::Z_SLAB_MODE;
+
+    int status = translator->PieceToExtentThreadSafe(piece, numPieces, 0, this->WholeExtent,
+                                                    pieceExtent, splitMode, 0);
+
+    //ghost planes are clamped to the whole extent by the translator, so none are added
+    //  across the phi seam
+    translator->PieceToExtentThreadSafe(piece, numPieces, ghostLevels, this->WholeExtent,
+                                        updateExtent, splitMode, 0);
+    translator->Delete();
+
+    if(!status || pieceExtent[2] > pieceExtent[3] || pieceExtent[4] > pieceExtent[5])
+    {
+        int emptyExtent[6] = {0, -1, 0, -1, 0, -1};
+        this->setMyExtents(updateExtent, emptyExtent);
+        this->setMyExtents(pieceExtent, emptyExtent);
+        ghostLevels = 0;
+        return 0;
+    }
+
+    return 1;
+}
+
+//---------------------------------------------------------------------------------------------
+//Restricts WholeExtent to the index plane of the OutputMode (closest to the requested
+// angle or radius), so the pipeline only asks for, and the files are only read at,
+// that plane.  The volume mode leaves WholeExtent alone.
+// Returns 0 if the grid coordinates cannot be read.
+int vtkEnlilReader::restrictToOutputPlane()
+{
+    int axis = 0;
+    double target = 0;
+
+    switch(this->OutputMode)
+    {
+    case OUTPUT_MODE::EQUATORIAL:
+        axis = 1;
+        target = vtkMath::Pi()/2;
+        break;
+
+    case OUTPUT_MODE::MERIDIONAL:
+        axis = 2;
+        target = vtkMath::RadiansFromDegrees(this->MeridionalLongitude);
+        break;
+
+    case OUTPUT_MODE::SPHERE:
+        axis = 0;
+        target = this->SphereRadius*GRID_SCALE::ScaleFactor[GRID_SCALE::AU];
+        break;
+
+    default:
+        return 1;
+    }
+
+    //the periodic phi plane is a copy of plane 0
+    int axisExtent[2] = {0, this->Dimension[axis]-1};
+    if(axis == 2)
+    {
+        axisExtent[1] = std::max(0, this->Dimension[2]-2);
+    }
+
+    const char* names[3] = {"X1", "X2", "X3"};
+    double* coords = this->readGridPartialToArray((char*)names[axis], axisExtent, false);
+    if(coords == NULL)
+    {
+        return 0;
+    }
+
+    int nearest = 0;
+    double nearestDistance = -1;
+
+    for(int x = 0; x <= axisExtent[1]; x++)
+    {
+        double distance = fabs(coords[x] - target);
 
-    //Import the MetaData
-    this->LoadMetaData(outputVector);
+        //longitudes wrap around
+        if(axis == 2)
+        {
+            distance = fmod(distance, 2*vtkMath::Pi());
+            distance = std::min(distance, 2*vtkMath::Pi() - distance);
+        }
 
-    //    std::cout << __FUNCTION__ <<  " Loaded MetaData" << std::endl;
-    this->SetProgress(.05);
+        if(nearestDistance < 0 || distance < nearestDistance)
+        {
+            nearest = x;
+            nearestDistance = distance;
+        }
+    }
 
-    //Import the actual Data
-    this->LoadVariableData(outputVector);
+    delete [] coords;
 
-    this->SetProgress(1.00);
+    this->WholeExtent[2*axis] = nearest;
+    this->WholeExtent[2*axis+1] = nearest;
 
-    //    std::cout << __FUNCTION__ << " Stop" << std::endl;
     return 1;
-
 }
 
 //---------------------------------------------------------------------------------------------
@@ -459,22 +1644,220 @@ double vtkEnlilReader::getRequestedTime(vtkInformationVector* outputVector)
             requestedTimeValue = this->TimeSteps[0];
         }
 
-        //set the modified julian date
-        this->current_MJD = requestedTimeValue;
-
         //        std::cout << "Requested Time Step: " << setprecision(12) << requestedTimeValue << std::endl;
     }
 
+    //current_MJD (the cache key) is set by setCurrentTimeStep, under the ReadLock
     return requestedTimeValue;
 }
 
 
+//---------------------------------------------------------------------------------------------
+//points the read paths and meta-data at time step time
+void vtkEnlilReader::setCurrentTimeStep(double time)
+{
+    this->CurrentFileName = (char*)this->time2fileMap[time].c_str();
+    this->CurrentPhysicalTime = this->time2physicaltimeMap[time];
+    this->CurrentDateTimeString = (char*) this->time2datestringMap[time].c_str();
+    this->CurrentRecord = this->time2recordMap[time];
+    this->current_MJD = time;
+
+    //hack to be fixed
+    this->FileName = this->CurrentFileName;
+}
+
+//---------------------------------------------------------------------------------------------
+//With TemporalInterpolation on, finds the time steps on either side of the requested time
+// and the weight of the later one.  Returns false when the requested time is on (or
+// outside of) the time steps, which are then read as they are.
+bool vtkEnlilReader::getInterpolationBracket(vtkInformationVector *outputVector, double &earlier, double &later, double &weight)
+{
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+    if(!this->TemporalInterpolation || this->TimeSteps.size() < 2
+            || !outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP()))
+    {
+        return false;
+    }
+
+    double requested = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+
+    //first time step after the requested time
+    std::vector<double>::iterator upper = std::upper_bound(this->TimeSteps.begin(), this->TimeSteps.end(), requested);
+    if(upper == this->TimeSteps.begin() || upper == this->TimeSteps.end())
+    {
+        return false;
+    }
+
+    later = *upper;
+    earlier = *(upper-1);
+
+    if(requested <= earlier || later <= earlier)
+    {
+        return false;
+    }
+
+    weight = (requested - earlier)/(later - earlier);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//Loads the selected arrays of the time steps earlier and later (through the cache) and
+// outputs (1-weight)*earlier + weight*later of every array they share.  Arrays that only
+// one of the steps has are left out.  The meta-data is that of the time step nearest to
+// the requested time.
+//
+// The arrays of both steps are kept in BracketArrays.  While the bracket, the extent
+// and the settings are unchanged, only the step CurrentArrays hold is loaded again
+// (which reads nothing), for the grid and the output arrays.
+int vtkEnlilReader::LoadInterpolatedData(vtkInformationVector *outputVector, double earlier, double later, double weight)
+{
+    vtkStructuredGrid* Data = vtkStructuredGrid::GetData(outputVector, 0);
+    vtkPointData* pointData = Data->GetPointData();
+
+    int newExtent[6];
+    int pieceExtent[6];
+    int ghostLevels = 0;
+    if(!this->getUpdateExtent(outputVector->GetInformationObject(0), newExtent, pieceExtent, ghostLevels))
+    {
+        //nothing for this piece to read
+        return this->LoadVariableData(outputVector);
+    }
+
+    //anything kept for another extent, other settings or other steps is stale
+    if(!this->eq(this->BracketExtent, newExtent) || this->BracketMTime != this->GetMTime())
+    {
+        this->BracketArrays.clear();
+    }
+
+    std::map<double, std::map<std::string, vtkSmartPointer<vtkFloatArray> > >::iterator step = this->BracketArrays.begin();
+    while(step != this->BracketArrays.end())
+    {
+        if(step->first != earlier && step->first != later)
+        {
+            this->BracketArrays.erase(step++);
+        }
+        else
+        {
+            ++step;
+        }
+    }
+
+    //load the steps that are not kept yet (the earlier one first), or else the one
+    //  CurrentArrays hold, which only sets up the grid and the output arrays
+    std::vector<double> toLoad;
+    if(this->BracketArrays.find(earlier) == this->BracketArrays.end())
+    {
+        toLoad.push_back(earlier);
+    }
+    if(this->BracketArrays.find(later) == this->BracketArrays.end())
+    {
+        toLoad.push_back(later);
+    }
+    if(toLoad.empty())
+    {
+        toLoad.push_back(this->BracketCurrent);
+    }
+
+    for(size_t t = 0; t < toLoad.size(); t++)
+    {
+        this->setCurrentTimeStep(toLoad[t]);
+        if(!this->LoadVariableData(outputVector))
+        {
+            this->BracketArrays.clear();
+            return 0;
+        }
+        this->BracketCurrent = toLoad[t];
+
+        std::map<std::string, vtkSmartPointer<vtkFloatArray> > &arrays = this->BracketArrays[toLoad[t]];
+        arrays.clear();
+
+        for(int x = 0; x < pointData->GetNumberOfArrays(); x++)
+        {
+            vtkFloatArray* array = vtkFloatArray::SafeDownCast(pointData->GetAbstractArray(x));
+            if(array != NULL && array->GetName() != NULL && array != this->Radius)
+            {
+                arrays[array->GetName()] = array;
+            }
+        }
+    }
+
+    this->setMyExtents(this->BracketExtent, this->SubExtent);
+    this->BracketMTime = this->GetMTime();
+
+    const std::map<std::string, vtkSmartPointer<vtkFloatArray> > &earlierArrays = this->BracketArrays[earlier];
+    const std::map<std::string, vtkSmartPointer<vtkFloatArray> > &laterArrays = this->BracketArrays[later];
+
+    //the output holds the arrays of the step loaded last.  They are shared with the cache,
+    //  so blend into new ones
+    std::vector<vtkSmartPointer<vtkFloatArray> > blended;
+    std::vector<std::string> unmatched;
+
+    for(int x = 0; x < pointData->GetNumberOfArrays(); x++)
+    {
+        vtkFloatArray* array = vtkFloatArray::SafeDownCast(pointData->GetAbstractArray(x));
+        if(array == NULL || array->GetName() == NULL || array == this->Radius)
+        {
+            continue;
+        }
+
+        std::map<std::string, vtkSmartPointer<vtkFloatArray> >::const_iterator first = earlierArrays.find(array->GetName());
+        std::map<std::string, vtkSmartPointer<vtkFloatArray> >::const_iterator second = laterArrays.find(array->GetName());
+
+        if(first == earlierArrays.end() || second == laterArrays.end()
+                || first->second->GetNumberOfTuples() != second->second->GetNumberOfTuples()
+                || first->second->GetNumberOfComponents() != second->second->GetNumberOfComponents())
+        {
+            unmatched.push_back(array->GetName());
+            continue;
+        }
+
+        vtkSmartPointer<vtkFloatArray> output = vtkSmartPointer<vtkFloatArray>::New();
+        output->SetName(array->GetName());
+        output->SetNumberOfComponents(array->GetNumberOfComponents());
+        output->SetNumberOfTuples(array->GetNumberOfTuples());
+
+        enlilTemporalBlend blend;
+        blend.earlier = first->second->GetPointer(0);
+        blend.later = second->second->GetPointer(0);
+        blend.output = output->GetPointer(0);
+        blend.weight = weight;
+
+        vtkSMPTools::For(0, (vtkIdType)output->GetNumberOfTuples()*output->GetNumberOfComponents(), blend);
+
+        blended.push_back(output);
+    }
+
+    //an array of only one of the steps would show that step's values under its name
+    for(size_t x = 0; x < unmatched.size(); x++)
+    {
+        std::cerr << "Array " << unmatched[x] << " is not in both time steps, so it is not interpolated." << std::endl;
+        pointData->RemoveArray(unmatched[x].c_str());
+    }
+
+    for(size_t x = 0; x < blended.size(); x++)
+    {
+        pointData->AddArray(blended[x]);
+    }
+
+    vtkSmartPointer<vtkFloatArray> weightArray = vtkSmartPointer<vtkFloatArray>::New();
+    weightArray->SetName("Interpolation Weight");
+    weightArray->SetNumberOfComponents(1);
+    weightArray->InsertNextValue(static_cast<float>(weight));
+    Data->GetFieldData()->AddArray(weightArray);
+
+    return 1;
+}
+
 //---------------------------------------------------------------------------------------------
 //Methods for file series
 
 void vtkEnlilReader::AddFileName(const char *fname)
 {
     this->fileNames.push_back(fname);
+
+    //the series changed, so its times have to be found again
+    this->timesCalulated = false;
     this->Modified();
 }
 
@@ -485,7 +1868,15 @@ const char* vtkEnlilReader::GetFileName(unsigned int idx)
 
 void vtkEnlilReader::RemoveAllFileNames()
 {
+    //the prefetcher may be reading one of these
+    this->Prefetcher->cancel();
+    QMutexLocker locker(&this->ReadLock);
+
     this->fileNames.clear();
+    this->MetaDataRecords.clear();
+
+    //don't hold on to files we may never read again
+    this->FilePool.closeAll();
     this->Modified();
 }
 
@@ -523,6 +1914,8 @@ void vtkEnlilReader::SelectionCallback(
 int vtkEnlilReader::LoadVariableData(vtkInformationVector* outputVector)
 {
     int newExtent[6];
+    int pieceExtent[6];
+    int ghostLevels = 0;
 
     vtkStructuredGrid* Data = vtkStructuredGrid::GetData(outputVector, 0);
     vtkInformation* fieldInfo = outputVector->GetInformationObject(0);
@@ -531,8 +1924,13 @@ int vtkEnlilReader::LoadVariableData(vtkInformationVector* outputVector)
 
     if(status)
     {
-        //get new extent request
-        fieldInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), newExtent);
+        //get new extent request (our slab of the grid when running in pieces)
+        if(!this->getUpdateExtent(fieldInfo, newExtent, pieceExtent, ghostLevels))
+        {
+            //more pieces than phi planes, nothing for this one to read
+            Data->SetExtent(newExtent);
+            return 1;
+        }
 
         //check to see if exents have changed
         if(!this->eq(this->SubExtent, newExtent))
@@ -551,12 +1949,18 @@ int vtkEnlilReader::LoadVariableData(vtkInformationVector* outputVector)
         this->extractDimensions(this->SubDimension, this->SubExtent);
 
         //Generate the Grid
-        this->GenerateGrid();
+        if(!this->GenerateGrid())
+        {
+            return 0;
+        }
 
         //set points and radius
         Data->SetPoints(this->Points);
         Data->GetPointData()->AddArray(this->Radius);
 
+        //keep what we already have for this request, read only what is new
+        this->validateCurrentArrays();
+
         //Load Variables
         int c = 0;
         double progress = 0.05;
@@ -572,13 +1976,18 @@ int vtkEnlilReader::LoadVariableData(vtkInformationVector* outputVector)
             }
         }
 
+        //Load Derived Data (and the point arrays read for it)
+        std::vector<std::string> fusedArrays;
+        this->LoadDerivedArrays(outputVector, fusedArrays);
+
         //Load Point Data
         for(c=0; c < this->PointDataArraySelection->GetNumberOfArrays(); c++)
         {
             std::string array = std::string(this->PointDataArraySelection->GetArrayName(c));
 
             //Load the current Point array
-            if(this->PointDataArraySelection->ArrayIsEnabled(array.c_str()))
+            if(this->PointDataArraySelection->ArrayIsEnabled(array.c_str())
+                    && std::find(fusedArrays.begin(), fusedArrays.end(), array) == fusedArrays.end())
             {
                 //                                std::cout << "Loading Array " << array << std::endl;
                 //                                std::cout << "   ArrayStatusSelection: " << this->PointDataArraySelection->ArrayIsEnabled(array.c_str())
@@ -598,768 +2007,1399 @@ int vtkEnlilReader::LoadVariableData(vtkInformationVector* outputVector)
                 progress += 0.1;
             }
         }
+
+        //mark the planes we read for our neighbours
+        if(ghostLevels > 0)
+        {
+            Data->GenerateGhostArray(pieceExtent);
+        }
+
+        //let go of the arrays that are no longer selected
+        std::map<std::string, vtkSmartPointer<vtkFloatArray> >::iterator current = this->CurrentArrays.begin();
+        while(current != this->CurrentArrays.end())
+        {
+            const char* name = current->first.c_str();
+            if(this->PointDataArraySelection->ArrayIsEnabled(name)
+                    || this->CellDataArraySelection->ArrayIsEnabled(name)
+                    || this->DerivedDataArraySelection->ArrayIsEnabled(name))
+            {
+                ++current;
+            }
+            else
+            {
+                this->OutputArrays.erase(current->first);
+                this->CurrentArrays.erase(current++);
+            }
+        }
     }
 
     return 1;
 }
 
 //---------------------------------------------------------------------------------------------
-//-- Return 0 for Failure, 1 for Success --//
-
-//This method will load the data and convert to the assigned "DataUnits" value.
-//Currently, this process includes 2 types of units: Native and SWPC. As this changes,
-//we will need to incorporate the changes here.
-void vtkEnlilReader::readVector(std::string array, vtkFloatArray *DataArray,  vtkInformationVector* outputVector, const int &dataID)
+//CurrentArrays hold the (native) arrays of one file, record, SubExtent and Resolution.
+// OutputArrays hold their conversions to DataUnits.
+void vtkEnlilReader::validateCurrentArrays()
+{
+    std::string fileName = (this->FileName != NULL) ? this->FileName : "";
+
+    if(fileName != this->CurrentArraysFile || this->CurrentRecord != this->CurrentArraysRecord
+            || !this->eq(this->SubExtent, this->CurrentArraysExtent)
+            || this->Resolution != this->CurrentArraysResolution)
+    {
+        this->CurrentArrays.clear();
+        this->OutputArrays.clear();
+
+        this->CurrentArraysFile = fileName;
+        this->CurrentArraysRecord = this->CurrentRecord;
+        this->CurrentArraysResolution = this->Resolution;
+        this->setMyExtents(this->CurrentArraysExtent, this->SubExtent);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+bool vtkEnlilReader::addCurrentArray(vtkStructuredGrid *Data, const std::string &name)
+{
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> >::iterator current = this->CurrentArrays.find(name);
+
+    if(current == this->CurrentArrays.end())
+    {
+        return false;
+    }
+
+    this->addOutputArray(Data, current->second);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//SWPC units: velocities in km/s, dynamic pressure in nPa and plasma density normalized to
+// n r^2 in cm^-3.  Everything else is the same in both systems.
+bool vtkEnlilReader::getUnitConversion(const std::string &name, double &factor, bool &byRadius)
+{
+    factor = 1.0;
+    byRadius = false;
+
+    if(this->DataUnits != 1)
+    {
+        return false;
+    }
+
+    //derived names contain "Velocity" and "Density" too, so they go first
+    if(name == DERIVED::Names[DERIVED::VMAG])
+    {
+        factor = 1.0 / UNITS::km2m;
+        return true;
+    }
+
+    if(name == DERIVED::Names[DERIVED::PDYN])
+    {
+        factor = UNITS::Pa2nPa;
+        return true;
+    }
+
+    for(int x = 0; x < DERIVED::NUMBER; x++)
+    {
+        if(name == DERIVED::Names[x])
+        {
+            return false;
+        }
+    }
+
+    int dataID = -1;
+    this->getDataID(name, dataID);
+
+    if(dataID == DATA_TYPE::VELOCITY)
+    {
+        factor = 1.0 / UNITS::km2m;
+        return true;
+    }
+
+    if(dataID == DATA_TYPE::PDENSITY)
+    {
+        factor = 1.0 / (UNITS::emu*UNITS::km2cm);
+        byRadius = true;
+        return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------
+//returns native (an array of the current SubExtent) in DataUnits: native itself when no
+// conversion is needed, otherwise a converted copy, or native converted in place.
+vtkSmartPointer<vtkFloatArray> vtkEnlilReader::toDataUnits(vtkFloatArray *native, bool inPlace)
+{
+    vtkSmartPointer<vtkFloatArray> converted = native;
+
+    double factor = 1.0;
+    bool byRadius = false;
+
+    if(native == NULL || native->GetName() == NULL
+            || !this->getUnitConversion(native->GetName(), factor, byRadius))
+    {
+        return converted;
+    }
+
+    //the radius has to line up with the points of the array
+    if(byRadius && (this->Radius == NULL || this->Radius->GetNumberOfTuples() != native->GetNumberOfTuples()))
+    {
+        return converted;
+    }
+
+    if(!inPlace)
+    {
+        converted = vtkSmartPointer<vtkFloatArray>::New();
+        converted->SetName(native->GetName());
+        converted->SetNumberOfComponents(native->GetNumberOfComponents());
+        converted->SetNumberOfTuples(native->GetNumberOfTuples());
+    }
+
+    enlilUnitConversion convert;
+    convert.input = native->GetPointer(0);
+    convert.output = converted->GetPointer(0);
+    convert.radius = byRadius ? this->Radius->GetPointer(0) : NULL;
+    convert.numComponents = native->GetNumberOfComponents();
+    convert.factor = factor;
+
+    vtkSMPTools::For(0, native->GetNumberOfTuples(), convert);
+
+    return converted;
+}
+
+//---------------------------------------------------------------------------------------------
+//adds native (in DataUnits) to Data.  Conversions of the current arrays are kept until
+// the units, the grid scale or the request change.
+void vtkEnlilReader::addOutputArray(vtkStructuredGrid *Data, vtkFloatArray *native)
+{
+    if(native == NULL)
+    {
+        return;
+    }
+
+    std::string name = (native->GetName() != NULL) ? native->GetName() : "";
+
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> >::iterator output = this->OutputArrays.find(name);
+    if(output != this->OutputArrays.end())
+    {
+        Data->GetPointData()->AddArray(output->second);
+        return;
+    }
+
+    vtkSmartPointer<vtkFloatArray> converted = this->toDataUnits(native);
+
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> >::iterator current = this->CurrentArrays.find(name);
+    if(current != this->CurrentArrays.end() && current->second == native)
+    {
+        this->OutputArrays[name] = converted;
+    }
+
+    Data->GetPointData()->AddArray(converted);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::SetDataUnits(int _arg)
+{
+    if(this->DataUnits == _arg)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&this->ReadLock);
+
+    //the cache holds native values, so only the converted outputs are stale
+    this->DataUnits = _arg;
+    this->OutputArrays.clear();
+
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::SetGridScaleType(int value)
+{
+    if(this->GridScaleType == value)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&this->ReadLock);
+
+    //the grid is rescaled in place by GenerateGrid, it is not read again
+    this->GridScaleType = value;
+
+    //SWPC density is normalized by the scaled radius.  The cache holds native values,
+    // so only the converted outputs and n r^2 are stale.
+    this->OutputArrays.clear();
+    this->cleanDerivedCache(DERIVED::NR2);
+
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+//-- Return 0 for Failure, 1 for Success --//
+
+//This method will load the data in native units, which is what the cache holds.  The
+//selected "DataUnits" are applied when the array is handed to the output (toDataUnits).
+//
+//Components are read as float a chunk of phi planes at a time and converted straight
+//into DataArray, so only one chunk of spherical components is held at once.
+void vtkEnlilReader::readVector(std::string array, vtkFloatArray *DataArray,  vtkInformationVector* outputVector, const int &dataID)
+{
+    const vtkIdType planeSize = (vtkIdType)this->SubDimension[0]*this->SubDimension[1];
+    const int planesPerChunk = this->getPlanesPerChunk();
+
+    //configure DataArray, sized once
+    DataArray->SetNumberOfComponents(3);  //3-Dim Vector
+    DataArray->SetNumberOfTuples(planeSize*this->SubDimension[2]);
+
+    //one chunk of each spherical component
+    std::vector<float> newArrayR(planeSize*planesPerChunk);
+    std::vector<float> newArrayT(planeSize*planesPerChunk);
+    std::vector<float> newArrayP(planeSize*planesPerChunk);
+
+    // convert from spherical to cartesian, one phi plane per task
+    enlilSphericalToCartesian convert;
+    convert.R = &newArrayR[0];
+    convert.T = &newArrayT[0];
+    convert.P = &newArrayP[0];
+    convert.sinTheta = &this->sinTheta[0];
+    convert.cosTheta = &this->cosTheta[0];
+    convert.dimI  = this->SubDimension[0];
+    convert.dimJ  = this->SubDimension[1];
+    convert.scale = 1.0;
+
+    int chunkExtents[6];
+    this->setMyExtents(chunkExtents, this->SubExtent);
+
+    for(int k = 0; k < this->SubDimension[2]; k += planesPerChunk)
+    {
+        int planes = std::min(planesPerChunk, this->SubDimension[2] - k);
+        chunkExtents[4] = this->SubExtent[4] + k;
+        chunkExtents[5] = chunkExtents[4] + planes - 1;
+
+        //read in the chunk of each component
+        if(!this->readVariableToFloat(this->VectorVariableMap[array][0].c_str(), chunkExtents, &newArrayR[0]) ||
+                !this->readVariableToFloat(this->VectorVariableMap[array][1].c_str(), chunkExtents, &newArrayT[0]) ||
+                !this->readVariableToFloat(this->VectorVariableMap[array][2].c_str(), chunkExtents, &newArrayP[0]))
+        {
+            std::cerr << "Failed to read " << array << " from " << this->FileName << std::endl;
+
+            DataArray->SetNumberOfTuples(0);
+            return;
+        }
+
+        //convert the chunk into its place in the output
+        convert.sinPhi = &this->sinPhi[k];
+        convert.cosPhi = &this->cosPhi[k];
+        convert.output = DataArray->GetPointer(3*planeSize*k);
+
+        vtkSMPTools::For(0, planes, convert);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//Scalars are read as float (in native units) directly into DataArray, a chunk of phi
+//planes at a time.
+void vtkEnlilReader::readScalar(vtkStructuredGrid *Data, vtkFloatArray *DataArray, std::string array, vtkInformationVector* outputVector, int dataID)
+{
+    const vtkIdType planeSize = (vtkIdType)this->SubDimension[0]*this->SubDimension[1];
+    const int planesPerChunk = this->getPlanesPerChunk();
+
+    //configure DataArray, sized once
+    DataArray->SetNumberOfComponents(1);  //Scalar
+    DataArray->SetNumberOfTuples(planeSize*this->SubDimension[2]);
+
+    int chunkExtents[6];
+    this->setMyExtents(chunkExtents, this->SubExtent);
+
+    for(int k = 0; k < this->SubDimension[2]; k += planesPerChunk)
+    {
+        int planes = std::min(planesPerChunk, this->SubDimension[2] - k);
+        chunkExtents[4] = this->SubExtent[4] + k;
+        chunkExtents[5] = chunkExtents[4] + planes - 1;
+
+        float* chunk = DataArray->GetPointer(planeSize*k);
+
+        //get data array
+        if(!this->readVariableToFloat(this->ScalarVariableMap[array].c_str(), chunkExtents, chunk))
+        {
+            std::cerr << "Failed to read " << array << " from " << this->FileName << std::endl;
+
+            DataArray->SetNumberOfTuples(0);
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//Reduces the selected point arrays over every time step of the run: time maximum, time
+//mean and arrival time.  Only the selected variables of the update extent are read, one
+//time step at a time.  While a step is folded into the accumulators, the next one is
+//read by a second thread into the other of two sets of buffers, so reading and
+//reducing overlap.
+int vtkEnlilReader::LoadTemporalReduction(vtkInformationVector *outputVector)
 {
+    int newExtent[6];
+    int pieceExtent[6];
+    int ghostLevels = 0;
 
-    double xyz[3] = {0.0, 0.0, 0.0};
+    vtkStructuredGrid* Data = vtkStructuredGrid::GetData(outputVector, 0);
+    vtkInformation* fieldInfo = outputVector->GetInformationObject(0);
 
-    double* newArrayR;
-    double* newArrayT;
-    double* newArrayP;
+    if(!this->getUpdateExtent(fieldInfo, newExtent, pieceExtent, ghostLevels))
+    {
+        Data->SetExtent(newExtent);
+        return 1;
+    }
 
-    int currentSize = 0;
-    double radius = 0.0;
+    if(!this->eq(this->SubExtent, newExtent))
+    {
+        this->setMyExtents(this->SubExtent, newExtent);
+        this->gridClean = false;
+    }
 
-    //configure DataArray
-    DataArray->SetNumberOfComponents(3);  //3-Dim Vector
+    Data->SetExtent(this->SubExtent);
+    this->extractDimensions(this->SubDimension, this->SubExtent);
 
-    //read in the arrays
-    newArrayR
-            = this->read3dPartialToArray((char*)this->VectorVariableMap[array][0].c_str(), this->SubExtent);
+    if(!this->GenerateGrid())
+    {
+        return 0;
+    }
 
-    newArrayT
-            = this->read3dPartialToArray((char*)this->VectorVariableMap[array][1].c_str(), this->SubExtent);
+    Data->SetPoints(this->Points);
+    Data->GetPointData()->AddArray(this->Radius);
 
-    newArrayP
-            = this->read3dPartialToArray((char*)this->VectorVariableMap[array][2].c_str(), this->SubExtent);
+    std::vector<std::string> arrays;
+    for(int c = 0; c < this->PointDataArraySelection->GetNumberOfArrays(); c++)
+    {
+        const char* name = this->PointDataArraySelection->GetArrayName(c);
+        if(this->PointDataArraySelection->ArrayIsEnabled(name))
+        {
+            arrays.push_back(std::string(name));
+        }
+    }
 
-    //get vector meta-data
-    this->loadVarMetaData((char*)this->VectorVariableMap[array][0].c_str(), array.c_str(), outputVector);
+    const int numSteps = this->TimeSteps.size();
+    if(arrays.empty() || numSteps == 0)
+    {
+        return 1;
+    }
 
+    const vtkIdType numPoints = (vtkIdType)this->SubDimension[0]*this->SubDimension[1]*this->SubDimension[2];
+    const size_t numArrays = arrays.size();
 
-    // convert from spherical to cartesian
-    int loc=0;
-    int i,j,k;
-    for(k=0; k<this->SubDimension[2]; k++)
+    //two sets of read buffers: one being read, one being reduced
+    std::vector<vtkSmartPointer<vtkFloatArray> > buffers[2];
+    for(int b = 0; b < 2; b++)
     {
-        for(j=0; j<this->SubDimension[1]; j++)
+        for(size_t x = 0; x < numArrays; x++)
         {
-            for(i=0; i<this->SubDimension[0]; i++)
+            buffers[b].push_back(vtkSmartPointer<vtkFloatArray>::New());
+        }
+    }
 
-            {
+    //accumulators and outputs of each array
+    std::vector<vtkSmartPointer<vtkFloatArray> > maximum(numArrays);
+    std::vector<vtkSmartPointer<vtkFloatArray> > mean(numArrays);
+    std::vector<vtkSmartPointer<vtkFloatArray> > arrival(numArrays);
+    std::vector<std::vector<double> > sum(numArrays, std::vector<double>(numPoints));
+    std::vector<std::vector<float> > baseline(numArrays, std::vector<float>(numPoints));
 
-                xyz[0] =newArrayR[loc]*sin(this->sphericalGridCoords[1][j])*cos(this->sphericalGridCoords[2][k]);
-                xyz[1] =newArrayR[loc]*sin(this->sphericalGridCoords[1][j])*sin(this->sphericalGridCoords[2][k]);
-                xyz[2] =newArrayR[loc]*cos(this->sphericalGridCoords[1][j]);
+    for(size_t x = 0; x < numArrays; x++)
+    {
+        std::string name = arrays[x];
+        if(this->VectorVariableMap.find(name) != this->VectorVariableMap.end())
+        {
+            name += " Magnitude";
+        }
 
-                xyz[0] += newArrayT[loc]*cos(this->sphericalGridCoords[1][j])*cos(this->sphericalGridCoords[2][k]);
-                xyz[1] += newArrayT[loc]*cos(this->sphericalGridCoords[1][j])*sin(this->sphericalGridCoords[2][k]);
-                xyz[2] += -1.0*newArrayT[loc]*sin(this->sphericalGridCoords[1][j]);
+        vtkSmartPointer<vtkFloatArray>* outputs[3] = {&maximum[x], &mean[x], &arrival[x]};
+        const char* suffixes[3] = {" Time Max", " Time Mean", " Arrival Time (h)"};
 
-                xyz[0] += -1.0*newArrayP[loc]*sin(this->sphericalGridCoords[2][k]);
-                xyz[1] += newArrayP[loc]*cos(this->sphericalGridCoords[2][k]);
+        for(int o = 0; o < 3; o++)
+        {
+            *outputs[o] = vtkSmartPointer<vtkFloatArray>::New();
+            (*outputs[o])->SetName((name + suffixes[o]).c_str());
+            (*outputs[o])->SetNumberOfComponents(1);
+            (*outputs[o])->SetNumberOfTuples(numPoints);
+        }
+    }
 
-                //adjust units:
-                if(this->DataUnits)
-                {
-                    switch(this->DataUnits)
-                    {
-                    case 1:
-                        switch(dataID)
-                        {
-                        case DATA_TYPE::VELOCITY:
-                            xyz[0] = xyz[0] / UNITS::km2m;
-                            xyz[1] = xyz[1] / UNITS::km2m;
-                            xyz[2] = xyz[2] / UNITS::km2m;
-                            break;
-
-                        default:
-                            break;
-                        }
-                        break;
+    //the read thread points the read paths at each step; put them back when done
+    char* savedFileName = this->FileName;
+    double savedMJD = this->current_MJD;
+    int savedRecord = this->CurrentRecord;
 
-                    default:
-                        break;
-                    }
-                }
+    enlilReductionReader io;
+    io.reader = this;
+    io.arrays = &arrays;
 
+    bool ok = this->readReductionStep(this->TimeSteps[0], arrays, buffers[0]);
+
+    int step = 0;
+    for(; ok && step < numSteps; step++)
+    {
+        //start reading the next step
+        bool reading = (step+1 < numSteps);
+        if(reading)
+        {
+            io.time = this->TimeSteps[step+1];
+            io.buffers = &buffers[(step+1) % 2];
+            io.ok = false;
+            io.start();
+        }
 
-                DataArray->InsertNextTuple(xyz);
+        //reduce this one
+        for(size_t x = 0; x < numArrays; x++)
+        {
+            vtkFloatArray* values = buffers[step % 2][x];
+
+            enlilTemporalAccumulator accumulate;
+            accumulate.values = values->GetPointer(0);
+            accumulate.numComponents = values->GetNumberOfComponents();
+            accumulate.first = (step == 0);
+            accumulate.hours = (this->TimeSteps[step] - this->TimeSteps[0])*24.0;
+            accumulate.factor = this->ArrivalFactor;
+            accumulate.maximum = maximum[x]->GetPointer(0);
+            accumulate.sum = &sum[x][0];
+            accumulate.baseline = &baseline[x][0];
+            accumulate.arrival = arrival[x]->GetPointer(0);
+
+            vtkSMPTools::For(0, numPoints, accumulate);
+        }
 
-                loc++;
+        if(reading)
+        {
+            io.wait();
+            ok = io.ok;
+        }
 
-            }
+        this->SetProgress(0.05 + 0.95*(step+1)/numSteps);
+        if(this->GetAbortExecute())
+        {
+            ok = false;
         }
+    }
+
+    this->FileName = savedFileName;
+    this->current_MJD = savedMJD;
+    this->CurrentRecord = savedRecord;
 
+    if(!ok)
+    {
+        std::cerr << "Temporal reduction stopped after " << step << " of " << numSteps
+                  << " time steps." << std::endl;
+        return 0;
+    }
 
+    for(size_t x = 0; x < numArrays; x++)
+    {
+        float* average = mean[x]->GetPointer(0);
+        for(vtkIdType p = 0; p < numPoints; p++)
+        {
+            average[p] = static_cast<float>(sum[x][p]/numSteps);
+        }
 
+        Data->GetPointData()->AddArray(maximum[x]);
+        Data->GetPointData()->AddArray(mean[x]);
+        Data->GetPointData()->AddArray(arrival[x]);
     }
 
-    //free temporary memory
-    delete [] newArrayR; newArrayR = NULL;
-    delete [] newArrayP; newArrayP = NULL;
-    delete [] newArrayT; newArrayT = NULL;
+    vtkSmartPointer<vtkIntArray> steps = vtkSmartPointer<vtkIntArray>::New();
+    steps->SetName("Reduced Time Steps");
+    steps->InsertNextValue(numSteps);
+    Data->GetFieldData()->AddArray(steps);
+
+    return 1;
 }
 
 //---------------------------------------------------------------------------------------------
-void vtkEnlilReader::readScalar(vtkStructuredGrid *Data, vtkFloatArray *DataArray, std::string array, vtkInformationVector* outputVector, int dataID)
+//Time series of the selected point arrays at the given locations.  Each location is
+//interpolated from the 8 grid points around it, found on the 1-D coordinate axes of
+//the first file, and only those points are read from each time step.  The time steps
+//are sampled in parallel.  Derived arrays are not sampled.
+int vtkEnlilReader::ExtractPointTimeSeries(const std::vector<double> &locations, vtkTable *output)
 {
-    DataArray->SetNumberOfComponents(1);  //Scalar
-
-    //array pointers
-    double* newArray;
-
-    //get data array
-    newArray
-            = this->read3dPartialToArray((char*)this->ScalarVariableMap[array].c_str(), this->SubExtent);
+    //the prefetcher may be reading
+    this->Prefetcher->cancel();
+    QMutexLocker locker(&this->ReadLock);
 
-    //Load meta data for array
-    this->loadVarMetaData((char*)this->ScalarVariableMap[array].c_str(), array.c_str(), outputVector);
+    output->Initialize();
 
+    const int numSteps = this->TimeSteps.size();
+    if(numSteps == 0 || this->fileNames.empty())
+    {
+        std::cerr << "No time steps to extract a time series from." << std::endl;
+        return 0;
+    }
 
-    //insert points
-    int k;
-    for(k=0; k<this->SubDimension[2]*this->SubDimension[1]*this->SubDimension[0]; k++)
+    //grid axes at full resolution.  The library lock is released before the
+    //  sampler threads start, as they take it themselves.
+    std::vector<double> axes[3];
     {
+        QMutexLocker library(&readerFilePool::libraryLock());
 
-        //adjust units:
-        if(this->DataUnits)
+        NcFile* file = this->FilePool.getFile(this->time2fileMap[this->TimeSteps[0]]);
+        if(file == NULL)
         {
-            switch(this->DataUnits)
-            {
-            case 1:
-                switch(dataID)
-                {
-                case DATA_TYPE::PDENSITY:
-                    newArray[k] = (newArray[k] * (this->Radius->GetValue(k)*this->Radius->GetValue(k)))/(UNITS::emu*UNITS::km2cm);
-                    break;
-
-                case DATA_TYPE::TEMP:
-                    break;
+            return 0;
+        }
 
-                case DATA_TYPE::CDENSITY:
-                    break;
+        const char* axisNames[3] = {"X1", "X2", "X3"};
+        for(int a = 0; a < 3; a++)
+        {
+            int varID = 0;
+            axes[a].resize(this->FileDimension[a]);
 
-                default:
-                    break;
-                }
-                break;
+            size_t start[2] = {0, 0};
+            size_t count[2] = {1, (size_t)this->FileDimension[a]};
 
-            default:
-                break;
+            int status = nc_inq_varid(file->id(), axisNames[a], &varID);
+            if(status == NC_NOERR)
+            {
+                status = nc_get_vara_double(file->id(), varID, start, count, &axes[a][0]);
+            }
+            if(status != NC_NOERR)
+            {
+                std::cerr << "Failed to read " << axisNames[a] << ": " << nc_strerror(status) << std::endl;
+                return 0;
             }
         }
-
-
-        DataArray->InsertNextValue(newArray[k]);
     }
 
-    //free temporary memory
-    delete [] newArray; newArray = NULL;
-}
+    //locations: r in grid scale units, colatitude and longitude in degrees
+    const double gridScale = GRID_SCALE::ScaleFactor[this->GridScaleType];
 
+    std::vector<enlilProbe> probes(locations.size()/3);
+    for(size_t p = 0; p < probes.size(); p++)
+    {
+        enlilProbe &probe = probes[p];
+        const double r = locations[3*p]*gridScale;
+        const double theta = vtkMath::RadiansFromDegrees(locations[3*p+1]);
+        const double phi = vtkMath::RadiansFromDegrees(locations[3*p+2]);
 
-//---------------------------------------------------------------------------------------------
-void vtkEnlilReader::getDataID(std::string array, int &dataID)
-{
-    QString arrayName(array.c_str());
+        probe.inside = enlilBracket(axes[0], r, false, probe.i, probe.wi)
+                && enlilBracket(axes[1], theta, false, probe.j, probe.wj)
+                && enlilBracket(axes[2], phi, true, probe.k, probe.wk);
 
-    if(arrayName.contains("Density") && arrayName.contains("cloud"))
-    {
-        dataID = DATA_TYPE::CDENSITY;
+        if(!probe.inside)
+        {
+            std::cerr << "Location " << p << " (" << locations[3*p] << ", " << locations[3*p+1]
+                      << ", " << locations[3*p+2] << ") is outside of the grid." << std::endl;
+        }
+
+        probe.sinTheta = sin(theta);
+        probe.cosTheta = cos(theta);
+        probe.sinPhi = sin(phi);
+        probe.cosPhi = cos(phi);
+        probe.radius = locations[3*p];
     }
-    else if (arrayName.contains("Density"))
+
+    //selected point arrays, with the same unit conversions as readScalar/readVector
+    std::vector<enlilProbeColumn> columns;
+    int valuesPerProbe = 0;
+
+    for(int c = 0; c < this->PointDataArraySelection->GetNumberOfArrays(); c++)
     {
-        dataID = DATA_TYPE::PDENSITY;
+        std::string name = this->PointDataArraySelection->GetArrayName(c);
+        if(!this->PointDataArraySelection->ArrayIsEnabled(name.c_str()))
+        {
+            continue;
+        }
+
+        enlilProbeColumn column;
+        column.name = name;
+        this->getUnitConversion(name, column.scale, column.scaleByRadius);
+
+        if(this->VectorVariableMap.find(name) != this->VectorVariableMap.end())
+        {
+            column.variables = this->VectorVariableMap[name];
+        }
+        else
+        {
+            column.variables.push_back(this->ScalarVariableMap[name]);
+        }
+
+        valuesPerProbe += column.variables.size();
+        columns.push_back(column);
     }
-    else if (arrayName.contains("Polarity"))
+
+    //every time step, in parallel
+    std::vector<std::string> files(numSteps);
+    std::vector<int> records(numSteps);
+    for(int step = 0; step < numSteps; step++)
     {
-        dataID = DATA_TYPE::POLARITY;
+        files[step] = this->time2fileMap[this->TimeSteps[step]];
+        records[step] = this->time2recordMap[this->TimeSteps[step]];
     }
-    else if(arrayName.contains("Magnetic"))
+
+    std::vector<double> values((size_t)numSteps*probes.size()*valuesPerProbe);
+    std::vector<char> status(numSteps, 0);
+
+    enlilProbeSampler sampler;
+    sampler.files = &files;
+    sampler.records = &records;
+    sampler.probes = &probes;
+    sampler.columns = &columns;
+    sampler.valuesPerProbe = valuesPerProbe;
+    sampler.output = values.empty() ? NULL : &values[0];
+    sampler.status = &status;
+
+    if(!values.empty())
     {
-        dataID = DATA_TYPE::BFIELD;
+        vtkSMPTools::For(0, numSteps, sampler);
+
+        int failed = numSteps - std::count(status.begin(), status.end(), 1);
+        if(failed > 0)
+        {
+            std::cerr << "Failed to sample " << failed << " of " << numSteps << " time steps." << std::endl;
+        }
     }
-    else if(arrayName.contains("Temperature"))
+
+    //time in seconds (the TIME of the files) and as MJD, then one column per array and location
+    vtkSmartPointer<vtkDoubleArray> time = vtkSmartPointer<vtkDoubleArray>::New();
+    time->SetName("Time");
+    time->SetNumberOfTuples(numSteps);
+
+    vtkSmartPointer<vtkDoubleArray> mjd = vtkSmartPointer<vtkDoubleArray>::New();
+    mjd->SetName("MJD");
+    mjd->SetNumberOfTuples(numSteps);
+
+    for(int step = 0; step < numSteps; step++)
     {
-        dataID = DATA_TYPE::TEMP;
+        time->SetValue(step, this->time2physicaltimeMap[this->TimeSteps[step]]);
+        mjd->SetValue(step, this->TimeSteps[step]);
     }
-    else if(arrayName.contains("Velocity"))
+
+    output->AddColumn(time);
+    output->AddColumn(mjd);
+
+    for(size_t p = 0; p < probes.size(); p++)
     {
-        dataID = DATA_TYPE::VELOCITY;
+        int offset = 0;
+        for(size_t c = 0; c < columns.size(); c++)
+        {
+            const int numComponents = columns[c].variables.size();
+
+            std::ostringstream name;
+            name << columns[c].name << " (" << p << ")";
+
+            vtkSmartPointer<vtkDoubleArray> column = vtkSmartPointer<vtkDoubleArray>::New();
+            column->SetName(name.str().c_str());
+            column->SetNumberOfComponents(numComponents);
+            column->SetNumberOfTuples(numSteps);
+
+            for(int step = 0; step < numSteps; step++)
+            {
+                const double* v = &values[((size_t)step*probes.size() + p)*valuesPerProbe + offset];
+                column->SetTupleValue(step, v);
+            }
+
+            output->AddColumn(column);
+            offset += numComponents;
+        }
     }
-}
 
+    return 1;
+}
 
 //---------------------------------------------------------------------------------------------
-int vtkEnlilReader::LoadArrayValues(std::string array, vtkInformationVector* outputVector)
+//Reads arrays of time step time for the current SubExtent into buffers (in output units).
+// Returns false if any of them could not be read.
+bool vtkEnlilReader::readReductionStep(double time, const std::vector<std::string> &arrays,
+                                       std::vector<vtkSmartPointer<vtkFloatArray> > &buffers)
 {
-    //get the dataID
-    int dataID = 0;
-    getDataID(array, dataID);
+    this->FileName = (char*)this->time2fileMap[time].c_str();
+    this->current_MJD = time;
+    this->CurrentRecord = this->time2recordMap[time];
 
-    bool vector
-            = (this->VectorVariableMap.find(std::string(array)) != this->VectorVariableMap.end());
+    const vtkIdType numPoints = (vtkIdType)this->SubDimension[0]*this->SubDimension[1]*this->SubDimension[2];
 
-    //get data from system
-    vtkStructuredGrid *Data = vtkStructuredGrid::GetData(outputVector,0);
+    for(size_t x = 0; x < arrays.size(); x++)
+    {
+        int dataID = 0;
+        this->getDataID(arrays[x], dataID);
 
-    //get the Xtents to play with
-    RCache::extents wholeExtents(this->WholeExtent);
-    RCache::extents subExtents(this->SubExtent);
+        if(this->VectorVariableMap.find(arrays[x]) != this->VectorVariableMap.end())
+        {
+            this->readVector(arrays[x], buffers[x], NULL, dataID);
+        }
+        else
+        {
+            this->readScalar(NULL, buffers[x], arrays[x], NULL, dataID);
+        }
 
-    //make the data array pointer available
-    vtkFloatArray *DataArray = NULL;
+        if(buffers[x]->GetNumberOfTuples() != numPoints)
+        {
+            return false;
+        }
 
-    //set up array to be added
+        //the buffers are ours, so convert them in place
+        this->toDataUnits(buffers[x], true);
+    }
 
-    //    std::cout << "Loading Fields" << std::endl << std::flush;
-    //    std::cout << "Vector Status: " << (vector ? "TRUE" : "FALSE") << std::endl << std::flush;
-    //    std::cout << "DataID: " << dataID << std::endl << std::flush;
+    return true;
+}
 
-    if(vector)  //load vector data
-    {
-        switch(dataID)
-        {
-        case DATA_TYPE::BFIELD:
-            //read the fields
-            if(this->bFieldCache.getExtentsFromCache(this->current_MJD, subExtents) == NULL)
-            {
-                //                std::cout << "BFIELD" << std::endl << std::flush;
+//---------------------------------------------------------------------------------------------
+//number of phi planes of the current SubExtent read per chunk
+int vtkEnlilReader::getPlanesPerChunk()
+{
+    const vtkIdType planeSize = (vtkIdType)this->SubDimension[0]*this->SubDimension[1];
 
-                DataArray = vtkFloatArray::New();
-                DataArray->SetName(array.c_str());
-                //this means the data is not in cache, so lets get it
-                readVector(array, DataArray, outputVector, dataID);
+    int planes = (planeSize > 0) ? (int)(ENLIL_CHUNK_POINTS / planeSize) : 1;
 
-                // we really cannot cache the ENTIRE dataset at 800+ MB per step
-                // so we are, for now, just limiting the cache to non-whole reads.
-                // This can be further improved, I am sure.
-                if(subExtents < wholeExtents)
-                {
-                    //add the element to the cache
-                    //lets not use the cache yet.. not ready for prime time
-                    //TODO: finish cache system
+    return std::max(1, std::min(planes, this->SubDimension[2]));
+}
 
-                    //this->bFieldCache.addCacheElement(this->current_MJD, subExtents, DataArray);
 
-                }
+//---------------------------------------------------------------------------------------------
+//Derived arrays are computed a chunk of phi planes at a time from the native variables.
+//Inputs (D, T, B, V) that are already loaded or cached are used as they are, the others
+//are read from the file.  Any selected input array that is read is produced in the same
+//pass, so its variables are only read once.  The names of those arrays are returned in
+//fusedArrays; they are already added to the output.
+int vtkEnlilReader::LoadDerivedArrays(vtkInformationVector *outputVector, std::vector<std::string> &fusedArrays)
+{
+    vtkStructuredGrid *Data = vtkStructuredGrid::GetData(outputVector,0);
 
-            }
-            else
-            {
-                //                std::cout << "BFIELD Cache" << std::endl << std::flush;
-                //                std::cout << "Getting Data From the Cache: " << std::endl;
-                //                this->printExtents(SubExtent, (char*)"Current Extents: ");
-                //                std::cout << "Current Time: " << this->current_MJD << std::endl;
+    RCache::extents subExtents(this->SubExtent);
+    subExtents.setStride(this->Resolution);
 
-                //get the data array from the cache system
-                DataArray = vtkFloatArray::SafeDownCast(this->bFieldCache.getExtentsFromCache(this->current_MJD, subExtents)->data);
+    const vtkIdType planeSize = (vtkIdType)this->SubDimension[0]*this->SubDimension[1];
+    const int planesPerChunk = this->getPlanesPerChunk();
 
+    //selected derived arrays that are not in the cache yet
+    vtkSmartPointer<vtkFloatArray> derived[DERIVED::NUMBER];
+    bool needD = false, needT = false, needB = false, needV = false;
+    int pending = 0;
 
-            }
+    for(int x = 0; x < DERIVED::NUMBER; x++)
+    {
+        if(!this->DerivedDataArraySelection->ArrayIsEnabled(DERIVED::Names[x])
+                || this->addCurrentArray(Data, DERIVED::Names[x]))
+        {
+            continue;
+        }
 
-            break;
+        RCache::cacheElement* cached = this->derivedCache[x].getExtentsFromCache(this->current_MJD, subExtents);
+        if(cached != NULL)
+        {
+            this->CurrentArrays[DERIVED::Names[x]] = vtkFloatArray::SafeDownCast(cached->data);
+            this->addOutputArray(Data, vtkFloatArray::SafeDownCast(cached->data));
+            continue;
+        }
 
-        case DATA_TYPE::VELOCITY:
+        derived[x] = vtkSmartPointer<vtkFloatArray>::New();
+        derived[x]->SetName(DERIVED::Names[x]);
+        derived[x]->SetNumberOfComponents(1);
+        derived[x]->SetNumberOfTuples(subExtents.getNumberOfPoints());
+        pending++;
 
-            if(this->velocityCache.getExtentsFromCache(this->current_MJD, subExtents) == NULL)
-            {
-                //                std::cout << "VELOCITY" << std::endl << std::flush;
+        needB = needB || x == DERIVED::BMAG || x == DERIVED::BETA;
+        needV = needV || x == DERIVED::VMAG || x == DERIVED::PDYN;
+        needD = needD || x == DERIVED::PDYN || x == DERIVED::BETA || x == DERIVED::NR2;
+        needT = needT || x == DERIVED::BETA;
+    }
 
+    if(pending == 0)
+    {
+        return 1;
+    }
 
-                DataArray = vtkFloatArray::New();
-                DataArray->SetName(array.c_str());
-                //this means the data is not in cache, so lets get it
-                readVector(array, DataArray, outputVector, dataID);
+    //inputs that are already loaded (or cached) for this step are not read again
+    vtkSmartPointer<vtkFloatArray> dResident, tResident, bResident, vResident;
+    if(needD)
+    {
+        dResident = this->getResidentArray("D", subExtents);
+    }
+    if(needT)
+    {
+        tResident = this->getResidentArray("T", subExtents);
+    }
+    if(needB)
+    {
+        bResident = this->getResidentArray("B1", subExtents);
+    }
+    if(needV)
+    {
+        vResident = this->getResidentArray("V1", subExtents);
+    }
 
-                // we really cannot cache the ENTIRE dataset at 800+ MB per step
-                // so we are, for now, just limiting the cache to non-whole reads.
-                // This can be further improved, I am sure.
-                if(subExtents < wholeExtents)
-                {
-                    //add the element to the cache
-                    //lets not use the cache yet.. not ready for prime time
-                    //TODO: finish cache system
+    const bool readD = needD && !dResident;
+    const bool readT = needT && !tResident;
+    const bool readB = needB && !bResident;
+    const bool readV = needV && !vResident;
+
+    //selected inputs that have to be read anyway come out of the same pass
+    vtkSmartPointer<vtkFloatArray> dArray = this->newFusedArray("D",  readD, subExtents, 1);
+    vtkSmartPointer<vtkFloatArray> tArray = this->newFusedArray("T",  readT, subExtents, 1);
+    vtkSmartPointer<vtkFloatArray> bArray = this->newFusedArray("B1", readB, subExtents, 3);
+    vtkSmartPointer<vtkFloatArray> vArray = this->newFusedArray("V1", readV, subExtents, 3);
+
+    //one chunk of each native input that is read, but not straight into an output
+    const size_t chunkSize = (size_t)planeSize*planesPerChunk;
+    std::vector<float> dChunk((readD && !dArray) ? chunkSize : 0);
+    std::vector<float> tChunk((readT && !tArray) ? chunkSize : 0);
+    std::vector<float> bChunk[3];
+    std::vector<float> vChunk[3];
+    for(int c = 0; c < 3; c++)
+    {
+        bChunk[c].resize(readB ? chunkSize : 0);
+        vChunk[c].resize(readV ? chunkSize : 0);
+    }
 
-                    //this->velocityCache.addCacheElement(this->current_MJD, subExtents, DataArray);
+    const char* bNames[3] = {"B1", "B2", "B3"};
+    const char* vNames[3] = {"V1", "V2", "V3"};
 
-                }
-            }
-            else
-            {
-                //                std::cout << "VELOCITY Cache" << std::endl << std::flush;
-                //                std::cout << "Getting Data From the Cache: " << std::endl;
-                //                this->printExtents(SubExtent, (char*)"Current Extents: ");
-                //                std::cout << "Current Time: " << this->current_MJD << std::endl;
+    //conversions of the inputs being loaded, same (native) units as readVector/readScalar
+    enlilSphericalToCartesian bConvert;
+    bConvert.sinTheta = &this->sinTheta[0];
+    bConvert.cosTheta = &this->cosTheta[0];
+    bConvert.dimI = this->SubDimension[0];
+    bConvert.dimJ = this->SubDimension[1];
+    bConvert.scale = 1.0;
 
-                //get the data array from the cache system
-                DataArray = vtkFloatArray::SafeDownCast(this->velocityCache.getExtentsFromCache(this->current_MJD, subExtents)->data);
+    enlilSphericalToCartesian vConvert = bConvert;
 
+    enlilDerivedQuantities kernel;
+    kernel.planeSize = planeSize;
+    kernel.bField = bArray ? &bConvert : NULL;
+    kernel.velocity = vArray ? &vConvert : NULL;
+    kernel.bStride = bResident ? 3 : 1;
+    kernel.vStride = vResident ? 3 : 1;
 
-            }
-            break;
+    int chunkExtents[6];
+    this->setMyExtents(chunkExtents, this->SubExtent);
 
-        default:
-            std::cout << "DEFAULT - THIS IS AN ERROR" << std::endl << std::flush;
+    for(int k = 0; k < this->SubDimension[2]; k += planesPerChunk)
+    {
+        int planes = std::min(planesPerChunk, this->SubDimension[2] - k);
+        chunkExtents[4] = this->SubExtent[4] + k;
+        chunkExtents[5] = chunkExtents[4] + planes - 1;
 
-            break;
-        }
+        const vtkIdType offset = planeSize*k;
+
+        //read each needed variable of the chunk that is not loaded yet, once
+        float* dValues = dResident ? dResident->GetPointer(offset)
+                                   : (dArray ? dArray->GetPointer(offset) : (readD ? &dChunk[0] : NULL));
+        float* tValues = tResident ? tResident->GetPointer(offset)
+                                   : (tArray ? tArray->GetPointer(offset) : (readT ? &tChunk[0] : NULL));
+
+        bool status = (!readD || this->readVariableToFloat("D", chunkExtents, dValues))
+                && (!readT || this->readVariableToFloat("T", chunkExtents, tValues));
 
-        //Add array to grid
-        if(DataArray)
+        for(int c = 0; c < 3 && status; c++)
         {
-            Data->GetPointData()->AddArray(DataArray);
+            status = (!readB || this->readVariableToFloat(bNames[c], chunkExtents, &bChunk[c][0]))
+                    && (!readV || this->readVariableToFloat(vNames[c], chunkExtents, &vChunk[c][0]));
+        }
 
-            // Call delete here. Both vtkPointData::AddArray() and now the cache::addCacheElement()
-            // methods are keeping a reference to the array.
-            DataArray->Delete();
+        if(!status)
+        {
+            std::cerr << "Failed to read derived array inputs from " << this->FileName << std::endl;
+            return 0;
         }
 
+        kernel.D = dValues;
+        kernel.T = tValues;
+        kernel.radius = this->Radius->GetPointer(offset);
+        for(int c = 0; c < 3; c++)
+        {
+            kernel.B[c] = bResident ? bResident->GetPointer(3*offset + c) : (readB ? &bChunk[c][0] : NULL);
+            kernel.V[c] = vResident ? vResident->GetPointer(3*offset + c) : (readV ? &vChunk[c][0] : NULL);
+        }
 
+        for(int x = 0; x < DERIVED::NUMBER; x++)
+        {
+            kernel.output[x] = derived[x] ? derived[x]->GetPointer(offset) : NULL;
+        }
 
+        bConvert.R = kernel.B[0];
+        bConvert.T = kernel.B[1];
+        bConvert.P = kernel.B[2];
+        bConvert.sinPhi = &this->sinPhi[k];
+        bConvert.cosPhi = &this->cosPhi[k];
+        bConvert.output = bArray ? bArray->GetPointer(3*offset) : NULL;
+
+        vConvert.R = kernel.V[0];
+        vConvert.T = kernel.V[1];
+        vConvert.P = kernel.V[2];
+        vConvert.sinPhi = &this->sinPhi[k];
+        vConvert.cosPhi = &this->cosPhi[k];
+        vConvert.output = vArray ? vArray->GetPointer(3*offset) : NULL;
+
+        vtkSMPTools::For(0, planes, kernel);
     }
-    else    //load scalar data
+
+    //cache and output the derived arrays
+    for(int x = 0; x < DERIVED::NUMBER; x++)
     {
+        if(derived[x])
+        {
+            this->derivedCache[x].addCacheElement(this->current_MJD, subExtents, derived[x]);
+            this->CurrentArrays[DERIVED::Names[x]] = derived[x];
+            this->addOutputArray(Data, derived[x]);
+        }
+    }
 
-        switch(dataID)
+    //and the inputs loaded with them
+    vtkSmartPointer<vtkFloatArray> inputs[4] = {dArray, tArray, bArray, vArray};
+    const char* variables[4] = {"D", "T", "B1", "V1"};
+
+    for(int x = 0; x < 4; x++)
+    {
+        if(!inputs[x])
         {
-        case DATA_TYPE::PDENSITY:
+            continue;
+        }
 
-            //            std::cout << "Looking for PDentsity" << std::endl;
-            //            std::cout << "MJD: " << this->current_MJD << std::endl << std::flush;
-            //            std::cout << "Extents: " << subExtents.getExtent(0) << " " << subExtents.getExtent(1)
-            //                      << " " << subExtents.getExtent(2) << " " << subExtents.getExtent(3)
-            //                      << " " << subExtents.getExtent(4) << " " << subExtents.getExtent(5)
-            //                      << std::endl << std::flush;
+        std::string array = inputs[x]->GetName();
 
-            if(this->pDensityCache.getExtentsFromCache(this->current_MJD, subExtents) == NULL)
-            {
-                //                std::cout << "PDENSITY" << std::endl << std::flush;
+        int dataID = 0;
+        this->getDataID(array, dataID);
+        this->getArrayCache(dataID)->addCacheElement(this->current_MJD, subExtents, inputs[x]);
+        this->CurrentArrays[array] = inputs[x];
 
-                DataArray = vtkFloatArray::New();
-                DataArray->SetName(array.c_str());
-                readScalar(Data, DataArray, array, outputVector, dataID);
+        this->loadVarMetaData(variables[x], array.c_str(), outputVector);
+        this->addOutputArray(Data, inputs[x]);
 
-                if(subExtents < wholeExtents)
-                {
-                    //add the element to the cache
-                    //lets not use the cache yet.. not ready for prime time
-                    //TODO: finish cache system
+        fusedArrays.push_back(array);
+    }
 
-                    //this->pDensityCache.addCacheElement(this->current_MJD, subExtents, DataArray);
+    return 1;
+}
 
-                }
-            }
-            else
-            {
-                //SafeDownCast it
-                //                std::cout << "PDENSITY Cache" << std::endl << std::flush;
-                //                std::cout << "Getting Data From the Cache: " << std::endl;
-                //                this->printExtents(SubExtent, (char*)"Current Extents: ");
-                //                std::cout << "Current Time: " << this->current_MJD << std::endl;
+//---------------------------------------------------------------------------------------------
+//returns a new (sized) output array for the array read from variable if it is needed by a
+// derived quantity, selected, and not cached.  Otherwise returns NULL.
+vtkSmartPointer<vtkFloatArray> vtkEnlilReader::newFusedArray(const char *variable, bool needed, RCache::extents &xtents, int components)
+{
+    vtkSmartPointer<vtkFloatArray> DataArray;
 
-                //get the data array from the cache system
-                DataArray = vtkFloatArray::SafeDownCast(this->pDensityCache.getExtentsFromCache(this->current_MJD, subExtents)->data);
+    std::string array = this->getArrayNameOfVariable(variable);
+    if(!needed || array.empty() || !this->PointDataArraySelection->ArrayIsEnabled(array.c_str())
+            || this->CurrentArrays.find(array) != this->CurrentArrays.end())
+    {
+        return DataArray;
+    }
 
-            }
+    int dataID = 0;
+    this->getDataID(array, dataID);
 
-            break;
-        case DATA_TYPE::CDENSITY:
-            if(this->cDensityCache.getExtentsFromCache(this->current_MJD, subExtents) == NULL)
-            {
-                //                std::cout << "CDENSITY" << std::endl << std::flush;
+    RCache::ReaderCache* arrayCache = this->getArrayCache(dataID);
+    if(arrayCache == NULL || arrayCache->getExtentsFromCache(this->current_MJD, xtents) != NULL)
+    {
+        return DataArray;
+    }
 
+    DataArray = vtkSmartPointer<vtkFloatArray>::New();
+    DataArray->SetName(array.c_str());
+    DataArray->SetNumberOfComponents(components);
+    DataArray->SetNumberOfTuples(xtents.getNumberOfPoints());
 
-                DataArray = vtkFloatArray::New();
-                DataArray->SetName(array.c_str());
-                readScalar(Data, DataArray, array, outputVector, dataID);
+    return DataArray;
+}
 
-                if(subExtents < wholeExtents)
-                {
-                    //add the element to the cache
-                    //lets not use the cache yet.. not ready for prime time
-                    //TODO: finish cache system
+//---------------------------------------------------------------------------------------------
+//returns the (native) array read from variable if it is already loaded for this request or
+// cached for xtents, so it does not have to be read again.  Otherwise returns NULL.
+vtkSmartPointer<vtkFloatArray> vtkEnlilReader::getResidentArray(const char *variable, RCache::extents &xtents)
+{
+    vtkSmartPointer<vtkFloatArray> resident;
 
-                    //this->cDensityCache.addCacheElement(this->current_MJD, subExtents, DataArray);
+    std::string array = this->getArrayNameOfVariable(variable);
+    if(array.empty())
+    {
+        return resident;
+    }
 
-                }
-            }
-            else
-            {
-                //                std::cout << "CDENSITY Cache" << std::endl << std::flush;
-                //                std::cout << "Getting Data From the Cache: " << std::endl;
-                //                this->printExtents(SubExtent, (char*)"Current Extents: ");
-                //                std::cout << "Current Time: " << this->current_MJD << std::endl;
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> >::iterator current = this->CurrentArrays.find(array);
+    if(current != this->CurrentArrays.end())
+    {
+        resident = current->second;
+        return resident;
+    }
 
-                //get the data array from the cache system
-                DataArray = vtkFloatArray::SafeDownCast(this->cDensityCache.getExtentsFromCache(this->current_MJD, subExtents)->data);
+    int dataID = 0;
+    this->getDataID(array, dataID);
 
-            }
-            break;
+    //held here, as the cache may let go of (or re-extract) it while the outputs are added
+    RCache::ReaderCache* arrayCache = this->getArrayCache(dataID);
+    RCache::cacheElement* cached = (arrayCache == NULL) ? NULL : arrayCache->getExtentsFromCache(this->current_MJD, xtents);
+    if(cached != NULL)
+    {
+        resident = vtkFloatArray::SafeDownCast(cached->data);
+    }
 
-        case DATA_TYPE::POLARITY:
-            if(this->polarityCache.getExtentsFromCache(this->current_MJD, subExtents) == NULL)
-            {
-                //                std::cout << "POLARITY" << std::endl << std::flush;
+    return resident;
+}
 
-                DataArray = vtkFloatArray::New();
-                DataArray->SetName(array.c_str());
-                readScalar(Data, DataArray, array, outputVector, dataID);
+//---------------------------------------------------------------------------------------------
+//returns the name of the point array read from variable (the first component for vectors)
+std::string vtkEnlilReader::getArrayNameOfVariable(const char *variable)
+{
+    std::map<std::string, std::string>::iterator scalar;
+    for(scalar = this->ScalarVariableMap.begin(); scalar != this->ScalarVariableMap.end(); ++scalar)
+    {
+        if(scalar->second == variable)
+        {
+            return scalar->first;
+        }
+    }
 
-                if(subExtents < wholeExtents)
-                {
-                    //add the element to the cache
-                    //lets not use the cache yet.. not ready for prime time
-                    //TODO: finish cache system
+    std::map<std::string, std::vector<std::string> >::iterator vector;
+    for(vector = this->VectorVariableMap.begin(); vector != this->VectorVariableMap.end(); ++vector)
+    {
+        if(!vector->second.empty() && vector->second[0] == variable)
+        {
+            return vector->first;
+        }
+    }
 
-                    //this->polarityCache.addCacheElement(this->current_MJD, subExtents, DataArray);
+    return std::string();
+}
 
-                }
-            }
-            else
-            {
-                //                std::cout << "POLARITY Cache" << std::endl << std::flush;
-                //                std::cout << "Getting Data From the Cache: " << std::endl;
-                //                this->printExtents(SubExtent, (char*)"Current Extents: ");
-                //                std::cout << "Current Time: " << this->current_MJD << std::endl;
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::getDataID(std::string array, int &dataID)
+{
+    QString arrayName(array.c_str());
 
-                //get the data array from the cache system
-                DataArray = vtkFloatArray::SafeDownCast(this->polarityCache.getExtentsFromCache(this->current_MJD, subExtents)->data);
+    if(arrayName.contains("Density") && arrayName.contains("cloud"))
+    {
+        dataID = DATA_TYPE::CDENSITY;
+    }
+    else if (arrayName.contains("Density"))
+    {
+        dataID = DATA_TYPE::PDENSITY;
+    }
+    else if (arrayName.contains("Polarity"))
+    {
+        dataID = DATA_TYPE::POLARITY;
+    }
+    else if(arrayName.contains("Magnetic"))
+    {
+        dataID = DATA_TYPE::BFIELD;
+    }
+    else if(arrayName.contains("Temperature"))
+    {
+        dataID = DATA_TYPE::TEMP;
+    }
+    else if(arrayName.contains("Velocity"))
+    {
+        dataID = DATA_TYPE::VELOCITY;
+    }
+}
 
-            }
-            break;
 
-        case DATA_TYPE::TEMP:
-            if(this->temperatureCache.getExtentsFromCache(this->current_MJD, subExtents) == NULL)
-            {
-                //                std::cout << "TEMPURATURE" << std::endl;
+//---------------------------------------------------------------------------------------------
+int vtkEnlilReader::LoadArrayValues(std::string array, vtkInformationVector* outputVector)
+{
+    //get the dataID
+    int dataID = 0;
+    getDataID(array, dataID);
 
-                DataArray = vtkFloatArray::New();
-                DataArray->SetName(array.c_str());
-                readScalar(Data, DataArray, array, outputVector, dataID);
+    bool vector
+            = (this->VectorVariableMap.find(std::string(array)) != this->VectorVariableMap.end());
 
-                if(subExtents < wholeExtents)
-                {
-                    //add the element to the cache
-                    //lets not use the cache yet.. not ready for prime time
-                    //TODO: finish cache system
+    //get data from system
+    vtkStructuredGrid *Data = vtkStructuredGrid::GetData(outputVector,0);
 
-                    //this->temperatureCache.addCacheElement(this->current_MJD, subExtents, DataArray);
+    //get the Xtents to play with
+    RCache::extents subExtents(this->SubExtent);
+    subExtents.setStride(this->Resolution);
 
-                }
+    //find the cache for this type of data
+    RCache::ReaderCache* arrayCache = this->getArrayCache(dataID);
 
-            }
-            else
-            {
-                //                std::cout << "TEMPURATURE Cache" << std::endl;
-                //                std::cout << "Getting Data From the Cache: " << std::endl;
-                //                this->printExtents(SubExtent, (char*)"Current Extents: ");
-                //                std::cout << "Current Time: " << this->current_MJD << std::endl;
+    if(arrayCache == NULL)
+    {
+        std::cerr << "Unknown array " << array << ". Cannot load." << std::endl;
+        return 0;
+    }
 
-                //get the data array from the cache system
-                DataArray = vtkFloatArray::SafeDownCast(this->temperatureCache.getExtentsFromCache(this->current_MJD, subExtents)->data);
+    //make the data array pointer available
+    vtkSmartPointer<vtkFloatArray> DataArray;
 
-            }
-            break;
+    //arrays produced for this request already are handed out again as they are
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> >::iterator current = this->CurrentArrays.find(array);
 
-        default:
-            //            std::cout << "DEFAULT - THIS IS AN ERROR" << std::endl;
+    //look for the requested extents (or a superset of them) in the cache
+    RCache::cacheElement* cached = NULL;
+    if(current == this->CurrentArrays.end())
+    {
+        cached = arrayCache->getExtentsFromCache(this->current_MJD, subExtents);
+    }
 
-            break;
+    if(current != this->CurrentArrays.end())
+    {
+        DataArray = current->second;
+    }
+    else if(cached == NULL)
+    {
+        //this means the data is not in cache, so lets get it
+        DataArray = vtkSmartPointer<vtkFloatArray>::New();
+        DataArray->SetName(array.c_str());
 
+        if(vector)
+        {
+            readVector(array, DataArray, outputVector, dataID);
         }
-
-        //Add array to grid
-        if(DataArray)
+        else
         {
-            Data->GetPointData()->AddArray(DataArray);
+            readScalar(Data, DataArray, array, outputVector, dataID);
+        }
 
-            // Call delete here. Both vtkPointData::AddArray() and now the cache::addCacheElement()
-            // methods are keeping a reference to the array.
-            DataArray->Delete();
+        // The cache is bounded by CacheSize, evicting the least recently used
+        // arrays (across all variables and times) when full.
+        if(DataArray->GetNumberOfTuples() == subExtents.getNumberOfPoints())
+        {
+            arrayCache->addCacheElement(this->current_MJD, subExtents, DataArray);
+            this->CurrentArrays[array] = DataArray;
         }
+    }
+    else
+    {
+        //get the data array from the cache system
+        DataArray = vtkFloatArray::SafeDownCast(cached->data);
+        this->CurrentArrays[array] = DataArray;
+    }
 
+    //get the variable meta-data
+    if(vector)
+    {
+        this->loadVarMetaData(this->VectorVariableMap[array][0].c_str(), array.c_str(), outputVector);
+    }
+    else
+    {
+        this->loadVarMetaData(this->ScalarVariableMap[array].c_str(), array.c_str(), outputVector);
+    }
 
+    //Add array to grid (in the selected units)
+    if(DataArray)
+    {
+        this->addOutputArray(Data, DataArray);
     }
 
     return 1;
 }
 
 //---------------------------------------------------------------------------------------------
-//-- returns array read via partial IO limited by extents --//
+//-- reads a 3d variable limited by extents as float into output (i fastest, k slowest) --//
 /* This method will automatically adjust for the periodic boundary
- *  condition that does not exist sequentially in file */
-double* vtkEnlilReader::read3dPartialToArray(char* arrayName, int extents[])
+ *  condition that does not exist sequentially in file.
+ *  Returns 0 for failure, 1 for success */
+int vtkEnlilReader::readVariableToFloat(const char *arrayName, int extents[], float *output)
 {
     int extDims[3] = {0,0,0};
-    size_t readDims[4]   = {1,1,1,1};
-    long readStart[4]  = {0,extents[4],extents[2],extents[0]};
 
     // get dimensions from extents
     this->extractDimensions(extDims, extents);
 
-    // Enlil encodes in reverse, so reverse the order, add fourth dimension 1st.
-    readDims[1] = extDims[2];
-    readDims[2] = extDims[1];
-    readDims[3] = extDims[0];
-
-    //find all conditions that need to be accounted for
-    bool periodic = false;
-    bool periodicRead = false;
-    bool periodicOnly = false;
+    const size_t planeSize = (size_t)extDims[0]*extDims[1];
+    const size_t stride = this->Resolution;
 
-    // this->printExtents(extents, (char*)"Loading Extents: ");
+    // the periodic phi plane (index periodicPlane) is not stored in the file
+    const int periodicPlane = this->Dimension[2]-1;
+    const int numFilePlanes = std::min(extents[5], periodicPlane-1) - extents[4] + 1;
 
-    if(extents[5] == this->WholeExtent[5])
+    //classic files are converted straight out of a memory map
+    readerMappedFile* mapped = this->FilePool.getMappedFile(this->FileName);
+    if(mapped != NULL && this->readMappedToFloat(mapped, arrayName, extents, output))
     {
-        periodic = true;
-        // std::cout << "Set Periodic" << std::endl;
+        return 1;
+    }
 
-        if(extents[4] > 0)
-        {
-            periodicRead = true;
-            // std::cout << "Set Periodic Read" << std::endl;
-            if(extents[4] == this->WholeExtent[5])
-            {
-                periodicOnly = true;
-                // std::cout << "Set Periodic Only" << std::endl;
+    //anything else goes through the library, which other readers may be using
+    QMutexLocker library(&readerFilePool::libraryLock());
 
-            }
-        }
-    }
-    else
+    //get the (shared) open file
+    NcFile* file = this->FilePool.getFile(this->FileName);
+    if(file == NULL)
     {
-        //  std::cout << "Non-Periodic" << std::endl;
-        //  dont need to do anything
-
+        return 0;
     }
 
-    // allocate memory for complete array
-    double *array = new double[extDims[0]*extDims[1]*extDims[2]];
+    int varID = 0;
+    int status = nc_inq_varid(file->id(), arrayName, &varID);
 
-    //open file
-    NcFile file(this->FileName);
-    NcVar* variable = file.get_var(arrayName);
-
-    // start to read in data
-    if(periodic && !periodicOnly)
+    // Enlil encodes in reverse, so reverse the order, add fourth dimension 1st.
+    //  Extents are in (possibly strided) grid indices, the file is at full resolution.
+    //  Files of a series hold one record, a container one per time step.
+    size_t readStart[4] = {(size_t)this->CurrentRecord, extents[4]*stride, extents[2]*stride, extents[0]*stride};
+    size_t readDims[4]  = {1, (size_t)std::max(numFilePlanes, 0), (size_t)extDims[1], (size_t)extDims[0]};
+    ptrdiff_t readStride[4] = {1, (ptrdiff_t)stride, (ptrdiff_t)stride, (ptrdiff_t)stride};
+
+    // read the planes that are in the file
+    if(status == NC_NOERR && numFilePlanes > 0)
     {
-        //adjust dims
-        readDims[1] = readDims[1]-1;
+        status = nc_get_vars_float(file->id(), varID, readStart, readDims, readStride, output);
+    }
 
-        //adjust the start point
-        variable->set_cur(readStart);
+    // fix periodic boundary if necesary
+    if(status == NC_NOERR && extents[5] == periodicPlane)
+    {
+        float* wedge = output + planeSize*(extDims[2]-1);
 
-        //read the file
-        variable->get(array, readDims);
+        if(extents[4] == 0 && numFilePlanes > 0)
+        {
+            //copy periodic data from begining to end
+            memcpy(wedge, output, planeSize*sizeof(float));
+        }
+        else
+        {
+            //read in periodic data and place at end of array
+            readStart[1] = 0;
+            readDims[1]  = 1;
 
+            status = nc_get_vars_float(file->id(), varID, readStart, readDims, readStride, wedge);
+        }
     }
-    else if(periodicOnly)
-    {
-        //set periodic only
-        readDims[1] = 1;
-        readStart[1] = 0;
-        readStart[2] = extents[2];
-        readStart[3] = extents[0];
 
-        //set read location
-        variable->set_cur(readStart);
+    if(status != NC_NOERR)
+    {
+        std::cerr << "Failed to read " << arrayName << ": " << nc_strerror(status) << std::endl;
+        return 0;
+    }
 
-        //read the file
-        variable->get(array, readDims);
+    return 1;
+}
 
+//---------------------------------------------------------------------------------------------
+//reads a block of a variable from a mapped classic file, the same way
+// readVariableToFloat does.  Returns false (nothing read) if the variable cannot be
+// read from the map, in which case the library has to be used.
+bool vtkEnlilReader::readMappedToFloat(readerMappedFile *mapped, const char *arrayName, int extents[], float *output)
+{
+    const readerNc3Header::variable* var = mapped->getHeader().getVariable(arrayName);
+
+    //only (time, phi, theta, r) float/double variables of the grid size
+    if(var == NULL || var->shape.size() != 4
+            || (var->type != readerNc3Header::NC3_FLOAT && var->type != readerNc3Header::NC3_DOUBLE)
+            || var->shape[1] != (unsigned long long)this->FileDimension[2]
+            || var->shape[2] != (unsigned long long)this->FileDimension[1]
+            || var->shape[3] != (unsigned long long)this->FileDimension[0])
+    {
+        return false;
     }
-    else
+
+    const unsigned char* source = mapped->getData(*var, this->CurrentRecord);
+    if(source == NULL)
     {
-        //set read location as stated
-        variable->set_cur(readStart);
+        return false;
+    }
 
-        //read as stated
-        variable->get(array, readDims);
+    int extDims[3] = {0,0,0};
+    this->extractDimensions(extDims, extents);
 
+    const size_t planeSize = (size_t)extDims[0]*extDims[1];
+    const int stride = this->Resolution;
+
+    const int periodicPlane = this->Dimension[2]-1;
+    const int numFilePlanes = std::min(extents[5], periodicPlane-1) - extents[4] + 1;
+
+    enlilBigEndianToFloat convert;
+    convert.source = source;
+    convert.isDouble = (var->type == readerNc3Header::NC3_DOUBLE);
+    convert.fileDimI = this->FileDimension[0];
+    convert.fileDimJ = this->FileDimension[1];
+    convert.startI = (vtkIdType)extents[0]*stride;
+    convert.startJ = (vtkIdType)extents[2]*stride;
+    convert.startK = (vtkIdType)extents[4]*stride;
+    convert.stride = stride;
+    convert.dimI = extDims[0];
+    convert.dimJ = extDims[1];
+    convert.output = output;
+
+    // convert the planes that are in the file
+    if(numFilePlanes > 0)
+    {
+        vtkSMPTools::For(0, numFilePlanes, convert);
     }
 
     // fix periodic boundary if necesary
-    if(periodic && !periodicRead && !periodicOnly)
+    if(extents[5] == periodicPlane)
     {
-        //copy periodic data from begining to end
-        size_t wedgeSize = (extDims[0]*extDims[1]);
-        size_t wedgeLoc  = (extDims[0]*extDims[1])*(extDims[2]-1);
+        float* wedge = output + planeSize*(extDims[2]-1);
 
-        for(int x = 0; x < wedgeSize; x++)
+        if(extents[4] == 0 && numFilePlanes > 0)
         {
-            //copy the wedge
-            array[wedgeLoc] = array[x];
-
-            //advance index
-            wedgeLoc++;
+            memcpy(wedge, output, planeSize*sizeof(float));
         }
-
-    }
-    else if (periodic && periodicRead && !periodicOnly)  /*periodicRead &&*/
-    {
-        //read in periodic data and place at end of array
-        size_t wedgeSize = extDims[0]*extDims[1];
-        size_t wedgeLoc  = (extDims[0]*extDims[1])*(extDims[2]-1);
-
-        double * wedge = new double[wedgeSize];
-
-        //start at 0,0,0
-        readStart[0] = 0;
-        readStart[1] = 0;
-        readStart[2] = extents[2];
-        readStart[3] = extents[0];
-
-        //restrict to phi = 1 dimension
-        readDims[1] = 1;
-
-        //set start
-        variable->set_cur(readStart);
-
-        //read data
-        variable->get(wedge, readDims);
-
-        //populate wedge to array
-        for(int x = 0; x < wedgeSize; x++)
+        else
         {
-            //copy the wedge
-            array[wedgeLoc] = wedge[x];
-
-            //advance index
-            wedgeLoc++;
+            convert.startK = 0;
+            convert.output = wedge;
+            convert(0, 1);
         }
-
-        //free temp memory
-        delete [] wedge; wedge = NULL;
     }
 
-
-    //close file
-    file.close();
-
-    return array;
-
+    return true;
 }
 
 //---------------------------------------------------------------------------------------------
 //-- returns array read via partial IO limited by extents --//
 /* This method will automatically adjust for the periodic boundary
- *  condition that does not exist sequentially in file */
+ *  condition that does not exist sequentially in file.
+ *  subExtents are (possibly strided) grid indices along one axis. */
 double* vtkEnlilReader::readGridPartialToArray(char *arrayName, int subExtents[], bool isPeriodic = false)
 {
-    int     extDim = subExtents[1]-subExtents[0]+1;;
-    size_t  readDims[2]  = {1,extDim};
-    long    readStart[2] = {0,subExtents[0]};
-
-    //Find conditions that need to be handled
-    bool periodic = false;
-    bool periodicRead = false;
-    bool periodicOnly = false;
-
-    //if isPeriodic is set, then we are looking at phi
-    if(isPeriodic)
-    {
-        if(subExtents[1] == this->WholeExtent[5])
-        {
-            periodic = true;
-            if(subExtents[0] > 0)
-            {
-                periodicRead = true;
-                if(subExtents[0] == this->WholeExtent[5])
-                {
-                    periodicOnly = true;
-                }
-            }
-        }
-    }
+    const size_t stride = this->Resolution;
+    int extDim = subExtents[1]-subExtents[0]+1;
 
-    //allocate Memory for complete array
-    double *array = new double[extDim];
+    //if isPeriodic is set, then we are looking at phi, whose last plane is not in the file
+    bool periodic = isPeriodic && subExtents[1] == this->Dimension[2]-1;
+    int numFileValues = periodic ? extDim-1 : extDim;
 
-    //Open file
-    NcFile file(this->FileName);
-    NcVar* variable = file.get_var(arrayName);
+    QMutexLocker library(&readerFilePool::libraryLock());
 
-    //start to read in data
-    if(periodic && !periodicOnly)
+    //get the (shared) open file
+    NcFile* file = this->FilePool.getFile(this->FileName);
+    if(file == NULL)
     {
-
-        //adjust dims
-        readDims[1] = readDims[1]-1;
-
-        //adjust the start point
-        variable->set_cur(readStart);
-
-        //read the file
-        variable->get(array, readDims);
-
+        return NULL;
     }
-    else if(periodicOnly)
-    {
 
-        //set periodic only
-        readDims[1] = 1;
-        readStart[1] = 0;
+    int varID = 0;
+    int status = nc_inq_varid(file->id(), arrayName, &varID);
 
-        //set read location
-        variable->set_cur(readStart);
+    size_t    readStart[2]  = {0, subExtents[0]*stride};
+    size_t    readDims[2]   = {1, (size_t)numFileValues};
+    ptrdiff_t readStride[2] = {1, (ptrdiff_t)stride};
 
-        //read the file
-        variable->get(array, readDims);
+    //allocate Memory for complete array
+    double *array = new double[extDim];
 
-    }
-    else
+    //read the values that are in the file
+    if(status == NC_NOERR && numFileValues > 0)
     {
-        //set read location as stated
-        variable->set_cur(readStart);
-
-        //read as stated
-        variable->get(array, readDims);
+        status = nc_get_vars_double(file->id(), varID, readStart, readDims, readStride, array);
     }
 
     //fix periodic boundary if necesary
-    if(periodic && !periodicRead && !periodicOnly)
+    if(status == NC_NOERR && periodic)
     {
+        if(subExtents[0] == 0 && numFileValues > 0)
+        {
+            //copy periodic data from begining to end
+            array[extDim-1] = array[0];
+        }
+        else
+        {
+            //read in periodic data and place at end of array
+            readStart[1] = 0;
+            readDims[1] = 1;
 
-        //copy periodic data from begining to end
-        array[extDim-1] = array[0];
-
+            status = nc_get_vara_double(file->id(), varID, readStart, readDims, array + extDim-1);
+        }
     }
-    else if (periodic && periodicRead && !periodicOnly)
-    {
-
-        //read in periodic data and place at end of array
-        size_t wedgeSize = 1;
-        size_t wedgeLoc  = (extDim-1);
-
-        double * wedge = new double[wedgeSize];
 
-        //start at 0,0,0
-        readStart[1] = 0;
-
-        //restrict to phi = 1 dimension
-        readDims[1] = 1;
-
-        //set start
-        variable->set_cur(readStart);
-
-        //read data
-        variable->get(wedge, readDims);
-
-        //populate wedge to array
-
-        array[wedgeLoc] = wedge[0];
-
-        //free temp memory
-        delete [] wedge; wedge = NULL;
+    if(status != NC_NOERR)
+    {
+        std::cerr << "Failed to read " << arrayName << ": " << nc_strerror(status) << std::endl;
+        delete [] array;
+        return NULL;
     }
 
-    //close the file
-    file.close();
-
-    //return completed array
     return array;
 }
 
@@ -1376,101 +3416,121 @@ void vtkEnlilReader::loadVarMetaData(const char *array, const char* title,
     if(!status)
     {
         std::cerr << "Failed to get Data Structure in " << __FUNCTION__ << std::endl;
+        return;
     }
 
-    //open the file
-    NcFile file(this->FileName);
-    NcVar* variable = file.get_var(array);
-    NcType attType;
-
-    std::string* attname = NULL;
-    char* attSval = NULL;
-
-    double  attDval = 0.0;
-    int     attIval = 0;
-
-    std::string placeholder = std::string(title);
-    placeholder.append(" ");
-
-    std::string outputName;
-
-    //determine if any meta-data exists for array
-    int count = variable->num_atts();
-
-    //if so, load the meta data into arrays
-    for(int x = 0; x < count; x++)
+    metaDataRecord* record = this->getMetaDataRecord(this->FileName);
+    if(record == NULL)
     {
-        attname = new std::string(variable->get_att(x)->name());
-        attType = variable->get_att(x)->type();
-
-        outputName.clear();
-        outputName.assign(placeholder.c_str());
-        outputName.append(attname->c_str());
+        return;
+    }
 
-        // create the needed arrays
-        vtkNew<vtkStringArray>  MetaString;
-        vtkNew<vtkIntArray>     MetaInt;
-        vtkNew<vtkFloatArray>  MetaDouble;
+    //the attributes of a variable are only parsed the first time it is loaded from a file
+    std::vector<vtkSmartPointer<vtkAbstractArray> > &arrays = record->variableArrays[title];
 
-        //        std::cout << "Adding Attribute: " << outputName << std::endl;
+    if(arrays.empty())
+    {
+        QMutexLocker library(&readerFilePool::libraryLock());
 
-        switch(attType)
+        //get the (shared) open file
+        NcFile* file = this->FilePool.getFile(this->FileName);
+        NcVar* variable = (file == NULL) ? NULL : file->get_var(array);
+        if(variable == NULL)
         {
-        case ncByte:
-
-            //            std::cout << "Type: Byte" << std::endl;
-            //            std::cout << "Not implimented" << std::endl;
-            break;
-
-        case ncChar:
-
-            attSval = variable->get_att(x)->as_string(0);
-
-            MetaString->SetName(outputName.c_str());
-            MetaString->SetNumberOfComponents(1);
-            MetaString->InsertNextValue(attSval);
-
-            Data->GetFieldData()->AddArray(MetaString.GetPointer());
-            break;
+            return;
+        }
 
-        case ncShort:
-            //            std::cout << "Type: Short" << std::endl;
-            //            std::cout << "Not implimented" << std::endl;
-            break;
+        std::string placeholder = std::string(title);
+        placeholder.append(" ");
 
-        case ncInt:
+        //determine if any meta-data exists for array
+        int count = variable->num_atts();
 
-            attIval = variable->get_att(x)->as_int(0);
+        //if so, load the meta data into arrays
+        for(int x = 0; x < count; x++)
+        {
+            NcAtt* attribute = variable->get_att(x);
 
-            MetaInt->SetName(outputName.c_str());
-            MetaInt->SetNumberOfComponents(1);
-            MetaInt->InsertNextValue(attIval);
+            vtkAbstractArray* MetaArray = enlilAttributeToArray(attribute, placeholder + attribute->name());
+            if(MetaArray != NULL)
+            {
+                arrays.push_back(MetaArray);
+                MetaArray->Delete();
+            }
 
-            Data->GetFieldData()->AddArray(MetaInt.GetPointer());
-            break;
+            delete attribute;
+        }
+    }
 
-        case ncFloat:
-            //            std::cout << "Type: Float" << std::endl;
-            //            std::cout << "Not implimented" << std::endl;
-            break;
+    for(size_t x = 0; x < arrays.size(); x++)
+    {
+        Data->GetFieldData()->AddArray(arrays[x]);
+    }
+}
 
-        case ncDouble:
+//---------------------------------------------------------------------------------------------
+//returns the meta-data record of fileName, building its global (file) part on first use.
+// The time arrays come from the current time step, so this must be called for the
+// file (and record) being loaded.  Records of a container each get their own entry.
+vtkEnlilReader::metaDataRecord* vtkEnlilReader::getMetaDataRecord(const std::string &fileName)
+{
+    std::ostringstream key;
+    key << fileName << ":" << this->CurrentRecord;
 
-            attDval = variable->get_att(x)->as_double(0);
+    std::map<std::string, metaDataRecord>::iterator iter = this->MetaDataRecords.find(key.str());
+    if(iter != this->MetaDataRecords.end())
+    {
+        return &iter->second;
+    }
 
-            MetaDouble->SetName(outputName.c_str());
-            MetaDouble->SetNumberOfComponents(1);
-            MetaDouble->InsertNextValue(attDval);
+    //get metadate from file
+    QMutexLocker library(&readerFilePool::libraryLock());
+    NcFile* file = this->FilePool.getFile(fileName);
+    if(file == NULL)
+    {
+        return NULL;
+    }
 
-            Data->GetFieldData()->AddArray(MetaDouble.GetPointer());
-            break;
+    metaDataRecord &record = this->MetaDataRecords[key.str()];
+
+    //date string
+    vtkSmartPointer<vtkStringArray> DateString = vtkSmartPointer<vtkStringArray>::New();
+    DateString->SetName("DateString");
+    DateString->SetNumberOfComponents(1);
+    DateString->InsertNextValue(this->CurrentDateTimeString);
+    record.fileArrays.push_back(DateString);
+
+    //Load Physical Time
+    vtkSmartPointer<vtkFloatArray> physTime = vtkSmartPointer<vtkFloatArray>::New();
+    physTime->SetName("PhysicalTime");
+    physTime->SetNumberOfComponents(1);
+    physTime->InsertNextValue(this->CurrentPhysicalTime);
+    record.fileArrays.push_back(physTime);
+
+    //mjd is encoded as TIME already.  Do we want to put in here as well?
+    vtkSmartPointer<vtkFloatArray> currentMJD = vtkSmartPointer<vtkFloatArray>::New();
+    currentMJD->SetName("MJD");
+    currentMJD->SetNumberOfComponents(1);
+    currentMJD->InsertNextValue(this->current_MJD);
+    record.fileArrays.push_back(currentMJD);
+
+    //TODO: Need to strip spaces from meta-data names and reformat them with underscores
+    int natts = file->num_atts();
+    for(int q=0; q < natts; q++)
+    {
+        NcAtt* attribute = file->get_att(q);
 
-        default:
-            break;
+        vtkAbstractArray* MetaArray = enlilAttributeToArray(attribute, attribute->name());
+        if(MetaArray != NULL)
+        {
+            record.fileArrays.push_back(MetaArray);
+            MetaArray->Delete();
         }
 
+        delete attribute;
     }
 
+    return &record;
 }
 
 //---------------------------------------------------------------------------------------------
@@ -1496,169 +3556,171 @@ int vtkEnlilReader::PopulateArrays()
 //-- Meta Data Population
 int vtkEnlilReader::LoadMetaData(vtkInformationVector *outputVector)
 {
-    int ncFileID = 0;
-    int ncSDSID = 0;
-    int natts = 0;
-
-    NcType type;
-
-    char* attname;
-
-    char*    attvalc;
-    int     attvali;
-    double  attvald;
-
     vtkStructuredGrid *Data = vtkStructuredGrid::GetData(outputVector,0);
     int status = this->checkStatus(Data, (char*)"(MetaData)Structured Grid Data Object");
 
 
     if(status)
     {
-
-        //date string
-        vtkNew<vtkStringArray> DateString;
-        DateString->SetName("DateString");
-        DateString->SetNumberOfComponents(1);
-        DateString->InsertNextValue(this->CurrentDateTimeString);
-
-        Data->GetFieldData()->AddArray(DateString.GetPointer());
-
-        //Load Physical Time
-        vtkNew<vtkFloatArray> physTime;
-        physTime->SetName("PhysicalTime");
-        physTime->SetNumberOfComponents(1);
-        physTime->InsertNextValue(this->CurrentPhysicalTime);
-
-        Data->GetFieldData()->AddArray(physTime.GetPointer());
-
-        //mjd is encoded as TIME already.  Do we want to put in here as well?
-        vtkNew<vtkFloatArray> currentMJD;
-        currentMJD->SetName("MJD");
-        currentMJD->SetNumberOfComponents(1);
-        currentMJD->InsertNextValue(this->current_MJD);
-
-        Data->GetFieldData()->AddArray(currentMJD.GetPointer());
-
-        //get metadate from file
-        NcFile file(this->FileName);
-        natts = file.num_atts();
-
-        //TODO: Need to strip spaces from meta-data names and reformat them with underscores
-        for(int q=0; q < natts; q++)
+        //parsed the first time this file is visited, shared afterwards
+        metaDataRecord* record = this->getMetaDataRecord(this->FileName);
+        if(record == NULL)
         {
+            return 0;
+        }
 
-            vtkNew<vtkStringArray>  MetaString;
-            vtkNew<vtkIntArray>     MetaInt;
-            vtkNew<vtkFloatArray>  MetaDouble;
-
-            attname = (char*)file.get_att(q)->name();
-            type = file.get_att(q)->type();
-
-            switch(type)
-            {
-            case 1:
-                break;
-
-            case 2: //text
-
-                attvalc = file.get_att(q)->as_string(0);
-
-                MetaString->SetName(attname);
-                MetaString->SetNumberOfComponents(1);
-                MetaString->InsertNextValue(attvalc);
+        for(size_t x = 0; x < record->fileArrays.size(); x++)
+        {
+            Data->GetFieldData()->AddArray(record->fileArrays[x]);
+        }
+    }
 
-                Data->GetFieldData()->AddArray(MetaString.GetPointer());
-                break;
+    return 1;
+}
 
-            case 3:
-                break;
+//---------------------------------------------------------------------------------------------
+//Status Check
+int vtkEnlilReader::checkStatus(void *Object, char *name)
+{
+    if(Object == NULL)
+    {
+        std::cerr << "ERROR: " << name
+                  << " has failed to initialize"
+                  << std::endl;
 
-            case 4: //int
-                attvali = file.get_att(q)->as_int(0);
+        return 0;
+    }
 
-                MetaInt->SetName(attname);
-                MetaInt->SetNumberOfComponents(1);
-                MetaInt->InsertNextValue(attvali);
+    return 1;
+}
 
-                Data->GetFieldData()->AddArray(MetaInt.GetPointer());
-                break;
+//---------------------------------------------------------------------------------------------
+//this function calculates the positions of artifacts in the system (in HEEQ, meters) at
+// every time step, all at once, so serving them to the MetaData port is a lookup
+void vtkEnlilReader::calculateArtifacts()
+{
+    this->positions.clear();
 
-            case 5:
-                break;
+    //cxform reports errors through a global buffer, so the steps are transformed one
+    //  at a time.  It is only a few bodies per step.
+    for(size_t t = 0; t < this->TimeSteps.size(); t++)
+    {
+        //ephemeris seconds past J2000 (JD 2451545 = MJD 51544.5)
+        const double et = (this->TimeSteps[t] - 51544.5)*86400.0;
 
-            case 6: //double
-                attvald = file.get_att(q)->as_double(0);
+        std::map<std::string, std::vector<double> > step;
+        bool placed = true;
 
-                MetaDouble->SetName(attname);
-                MetaDouble->SetNumberOfComponents(1);
-                MetaDouble->InsertNextValue(attvald);
+        for(int a = 0; a < enlilNumberOfArtifacts; a++)
+        {
+            Vec in = { enlilArtifactGSE[a][0], enlilArtifactGSE[a][1], enlilArtifactGSE[a][2] };
+            Vec out = { 0.0, 0.0, 0.0 };
 
-                Data->GetFieldData()->AddArray(MetaDouble.GetPointer());
+            if(cxform("GSE", "HEEQ", et, in, out) != 0)
+            {
+                std::cerr << "Could not place the planets at MJD " << this->TimeSteps[t] << ": " << cxform_err() << std::endl;
+                placed = false;
                 break;
+            }
 
-            default:
-                break;
+            std::vector<double> &position = step[enlilArtifactNames[a]];
+            for(int c = 0; c < 3; c++)
+            {
+                position.push_back(out[c]*1000.0);
             }
         }
 
-        file.close();
+        if(placed)
+        {
+            this->positions[this->TimeSteps[t]].swap(step);
+        }
     }
-
-    return 1;
 }
 
 //---------------------------------------------------------------------------------------------
-//Status Check
-int vtkEnlilReader::checkStatus(void *Object, char *name)
+//-- Return 0 for failure, 1 for success --//
+//Outputs the artifacts at the time requested on the MetaData port as vertices (in grid
+// scale units) named by the "Name" point array.  Positions come from the table built by
+// calculateArtifacts; between time steps they are interpolated linearly.
+int vtkEnlilReader::LoadArtifacts(vtkInformationVector *outputVector)
 {
-    if(Object == NULL)
+    vtkPolyData* output = vtkPolyData::GetData(outputVector, 1);
+    vtkInformation* outInfo = outputVector->GetInformationObject(1);
+
+    if(output == NULL || this->positions.empty())
     {
-        std::cerr << "ERROR: " << name
-                  << " has failed to initialize"
-                  << std::endl;
+        return 1;
+    }
 
-        return 0;
+    //under pvserver, only the first piece carries the markers
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER())
+            && outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER()) > 0)
+    {
+        return 1;
     }
 
-    return 1;
-}
+    double requested = this->TimeSteps[0];
+    if(outInfo->Has(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP()))
+    {
+        requested = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+    }
 
-//---------------------------------------------------------------------------------------------
-//this function calculates the positions of artifacts in the system
-//void vtkEnlilReader::calculateArtifacts()
-//{
-//    DateTime time;
+    //bracketing entries of the table (the same one at or beyond the ends)
+    std::map<double, std::map<std::string, std::vector<double> > >::iterator later = this->positions.lower_bound(requested);
+    std::map<double, std::map<std::string, std::vector<double> > >::iterator earlier = later;
+
+    if(later == this->positions.end())
+    {
+        --later;
+        earlier = later;
+    }
+    else if(later != this->positions.begin() && later->first != requested)
+    {
+        --earlier;
+    }
+
+    double weight = 0;
+    if(later->first > earlier->first)
+    {
+        weight = (requested - earlier->first)/(later->first - earlier->first);
+    }
 
-//    int retError;
-//    int es;
+    const double scale = GRID_SCALE::ScaleFactor[this->GridScaleType];
 
-//    double jd;
-//    Vec pos_in, pos_out;
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToDouble();
 
-//    pos_in[0] = -1;
-//    pos_in[1] = 0;
-//    pos_in[2] = 0;
+    vtkSmartPointer<vtkCellArray> verts = vtkSmartPointer<vtkCellArray>::New();
 
-//    //lets calculate all positions, just once (TODO: check we do this only once)
-//    for(int x=0; x < this->NumberOfTimeSteps; x++)
-//    {
-//        time.setMJD(this->TimeSteps[x]);
-//        jd = gregorian_calendar_to_jd(time.getYear(),
-//                                      time.getMonth(),
-//                                      time.getDay(),
-//                                      time.getHour(),
-//                                      time.getMinute(),
-//                                      time.getSecond());
+    vtkSmartPointer<vtkStringArray> names = vtkSmartPointer<vtkStringArray>::New();
+    names->SetName("Name");
 
-//        es = date2es(time.getYear(),
-//                     time.getMonth(),
-//                     time.getDay(),
-//                     time.getHour(),
-//                     time.getMinute(),
-//                     time.getSecond());
+    std::map<std::string, std::vector<double> >::iterator body;
+    for(body = earlier->second.begin(); body != earlier->second.end(); ++body)
+    {
+        std::map<std::string, std::vector<double> >::iterator other = later->second.find(body->first);
+        if(other == later->second.end())
+        {
+            continue;
+        }
+
+        double xyz[3];
+        for(int c = 0; c < 3; c++)
+        {
+            xyz[c] = ((1.0-weight)*body->second[c] + weight*other->second[c]) / scale;
+        }
+
+        vtkIdType id = points->InsertNextPoint(xyz);
+        verts->InsertNextCell(1, &id);
+        names->InsertNextValue(body->first);
+    }
 
-//    }
-//}
+    output->SetPoints(points);
+    output->SetVerts(verts);
+    output->GetPointData()->AddArray(names);
+
+    return 1;
+}
 
 //---------------------------------------------------------------------------------------------
 //-- Return 0 for failure, 1 for success --//
@@ -1668,7 +3730,7 @@ int vtkEnlilReader::calculateTimeSteps()
 {
 
     /* Find Time Range.
-     * We need to open all files, calculate the time, and store locally.
+     * We need the time of all files (from the index or their headers), and store locally.
      * We need to keep track of current file
      * We don't want to re-calculate the times, just keep them available mapped to their file names
      * We also need to calculate the time range so ParaView knows what time steps we have.
@@ -1676,46 +3738,95 @@ int vtkEnlilReader::calculateTimeSteps()
 
     if(this->timesCalulated == false)
     {
+        if(this->fileNames.empty())
+        {
+            return 0;
+        }
+
+        this->TimeSteps.clear();
+        this->time2recordMap.clear();
 
-        //calculate number of time steps
-        //  This is easy, as there is one time step per file.
-        this->NumberOfTimeSteps = this->fileNames.size();
+        //a converted run keeps every time step (and a time index) in one container
+        if(this->fileNames.size() == 1 && this->calculateContainerTimeSteps(this->fileNames[0]))
+        {
+            this->NumberOfTimeSteps = this->TimeSteps.size();
+        }
+        else
+        {
+            //the hard part... get the time of every file.  Unchanged files come from
+            //  the sidecar index, the rest are scanned in parallel.
+            std::string indexFileName = readerTimeIndex::getIndexFileName(this->fileNames[0]);
+            readerTimeIndex index;
+            index.load(indexFileName);
+
+            int numberOfFiles = this->fileNames.size();
+            std::vector<readerTimeIndex::entry> entries(numberOfFiles);
+            std::vector<char> status(numberOfFiles, 0);
+
+            enlilTimeScanner scanner;
+            scanner.fileNames = &this->fileNames;
+            scanner.index = &index;
+            scanner.entries = &entries;
+            scanner.status = &status;
+            vtkSMPTools::For(0, numberOfFiles, 1, scanner);
+
+            //map the readable files to their calculated times, in series order.  The
+            //  file names are left as they were set, so a file that failed (perhaps
+            //  only this time) is scanned again when the series changes.
+            for (int x = 0; x < numberOfFiles; x++)
+            {
+                if(status[x] == 0)
+                {
+                    std::cerr << "Could not read the time from " << this->fileNames[x] << ", skipping it." << std::endl;
+                    continue;
+                }
 
-        //        std::cout << "Number of Time Steps: " << this->NumberOfTimeSteps << std::endl;
+                if(status[x] == 2)
+                {
+                    index.update(entries[x]);
+                }
 
-        //the hard part... open all of the files, map them to their calculated times
+                double mjd = entries[x].mjd;
+                this->TimeSteps.push_back(mjd);
 
-        for (int x = 0; x < this->NumberOfTimeSteps; x++)
-        {
-            NcFile data(this->fileNames[x].c_str());
-            NcVar* time = data.get_var("TIME");
-            NcAtt* mjd_start = data.get_att("refdate_mjd");
+                //populate physical time map
+                this->time2physicaltimeMap[mjd] = entries[x].physicalTime;
 
-            DateTime refDate(mjd_start->as_double(0));
-            double epochSeconds = refDate.getSecondsSinceEpoch();
-            epochSeconds += time->as_double(0);
+                //populate file map
+                this->time2fileMap[mjd] = this->fileNames[x];
 
-            refDate.incrementSeconds(time->as_double(0));
+                //populate datestring map
+                this->time2datestringMap[mjd].assign(entries[x].dateString);
 
-            this->TimeSteps.push_back(refDate.getMJD());
+                //one record per file
+                this->time2recordMap[mjd] = 0;
 
-            //populate physical time map
-            this->time2physicaltimeMap[this->TimeSteps[x]] = time->as_double(0);
-            data.close();
+                //            std::cout << "[" << x << "] MJD: " << mjd << std::endl;
+            }
 
-            //populate file map
-            this->time2fileMap[this->TimeSteps[x]] = this->fileNames[x];
+            //one time step per readable file
+            this->NumberOfTimeSteps = this->TimeSteps.size();
 
-            //populate datestring map
-            this->time2datestringMap[this->TimeSteps[x]].assign(refDate.getDateTimeString());
+            //keep the index for the next time the run is opened (read-only runs just rescan)
+            if(index.isModified())
+            {
+                index.save(indexFileName);
+            }
+        }
 
-            //            std::cout << "[" << x << "] MJD: " << this->TimeSteps[x] << std::endl;
+        if(this->NumberOfTimeSteps == 0)
+        {
+            std::cerr << "No readable ENLIL files in the series." << std::endl;
+            return 0;
         }
 
         //calculate time range
         this->timeRange[0] = this->TimeSteps[0];
         this->timeRange[1] = this->TimeSteps[this->NumberOfTimeSteps-1];
 
+        //planet and spacecraft positions of every time step, once
+        this->calculateArtifacts();
+
         this->timesCalulated = true;
     }
 
@@ -1723,21 +3834,93 @@ int vtkEnlilReader::calculateTimeSteps()
 }
 
 
+//---------------------------------------------------------------------------------------------
+//-- Return 0 if fileName is not a container written by enlilConverter --//
+/* A container holds every time step of a run as one record, with the time of
+ * each record in its time index, so no field has to be touched here. */
+int vtkEnlilReader::calculateContainerTimeSteps(const std::string &fileName)
+{
+    QMutexLocker library(&readerFilePool::libraryLock());
+
+    NcFile* file = this->FilePool.getFile(fileName);
+    if(file == NULL)
+    {
+        return 0;
+    }
+
+    const int ncid = file->id();
+
+    nc_type type;
+    size_t length = 0;
+    if(nc_inq_att(ncid, NC_GLOBAL, CONTAINER::Attribute, &type, &length) != NC_NOERR)
+    {
+        return 0;
+    }
+
+    int indexID = 0;
+    int timeID = 0;
+    int recordDim = 0;
+    size_t numberOfRecords = 0;
+
+    if(nc_inq_varid(ncid, CONTAINER::TimeIndex, &indexID) != NC_NOERR
+            || nc_inq_varid(ncid, "TIME", &timeID) != NC_NOERR
+            || nc_inq_vardimid(ncid, indexID, &recordDim) != NC_NOERR
+            || nc_inq_dimlen(ncid, recordDim, &numberOfRecords) != NC_NOERR
+            || numberOfRecords == 0)
+    {
+        std::cerr << fileName << " has no time index." << std::endl;
+        return 0;
+    }
+
+    std::vector<double> mjd(numberOfRecords);
+    std::vector<double> physicalTime(numberOfRecords);
+    size_t start = 0;
+
+    if(nc_get_vara_double(ncid, indexID, &start, &numberOfRecords, &mjd[0]) != NC_NOERR
+            || nc_get_vara_double(ncid, timeID, &start, &numberOfRecords, &physicalTime[0]) != NC_NOERR)
+    {
+        std::cerr << "Could not read the time index of " << fileName << std::endl;
+        return 0;
+    }
+
+    for(size_t x = 0; x < numberOfRecords; x++)
+    {
+        this->TimeSteps.push_back(mjd[x]);
+        this->time2physicaltimeMap[mjd[x]] = physicalTime[x];
+        this->time2fileMap[mjd[x]] = fileName;
+        this->time2datestringMap[mjd[x]] = DateTime(mjd[x]).getDateTimeString();
+        this->time2recordMap[mjd[x]] = (int)x;
+    }
+
+    return 1;
+}
+
 //---------------------------------------------------------------------------------------------
 //this function populates the grid data.  used to be calcuated with time steps, but
 //  the new timestep handling routine makes more sense to not include this.
 void vtkEnlilReader::PopulateGridData()
 {
-    //get the dimensions of the grid
-    NcFile grid(this->fileNames[0].c_str());
-    NcDim* dims_x = grid.get_dim(0);
-    NcDim* dims_y = grid.get_dim(1);
-    NcDim* dims_z = grid.get_dim(2);
+    //get the dimensions of the grid (from the first readable file)
+    QMutexLocker library(&readerFilePool::libraryLock());
+    NcFile* grid = this->FilePool.getFile(this->time2fileMap[this->TimeSteps[0]]);
+    if(grid == NULL)
+    {
+        return;
+    }
+    NcDim* dims_x = grid->get_dim(0);
+    NcDim* dims_y = grid->get_dim(1);
+    NcDim* dims_z = grid->get_dim(2);
+
+    this->FileDimension[0] = (int)dims_x->size();
+    this->FileDimension[1] = (int)dims_y->size();
+    this->FileDimension[2] = (int)dims_z->size();
 
-    //Populate Dimensions
-    this->Dimension[0] = (int)dims_x->size();
-    this->Dimension[1] = (int)dims_y->size();
-    this->Dimension[2] = (int)dims_z->size()+1;
+    //Populate Dimensions: every Resolution'th point, plus the periodic phi plane
+    //  that closes the sphere
+    const int stride = this->Resolution;
+    this->Dimension[0] = (this->FileDimension[0]-1)/stride + 1;
+    this->Dimension[1] = (this->FileDimension[1]-1)/stride + 1;
+    this->Dimension[2] = (this->FileDimension[2]+stride-1)/stride + 1;
 
     //Populate Extents
     this->setMyExtents(this->WholeExtent,
@@ -1745,8 +3928,7 @@ void vtkEnlilReader::PopulateGridData()
             0, this->Dimension[1]-1,
             0, this->Dimension[2]-1);
 
-    //done with grid, thus we now close it
-    grid.close();
+    //the grid file stays open in the pool
 
 }
 
@@ -1832,11 +4014,18 @@ void vtkEnlilReader::extractDimensions(int dims[], int extent[])
 //add a point array
 void vtkEnlilReader::addPointArray(char* name)
 {
-    NcFile file(this->FileName);
+    QMutexLocker library(&readerFilePool::libraryLock());
+
+    NcFile* file = this->FilePool.getFile(this->FileName);
+    if(file == NULL)
+    {
+        return;
+    }
+
     try
     {
         // look up the "Long Name" of the variable
-        std::string varname = file.get_var(name)->get_att("long_name")->as_string(0);
+        std::string varname = file->get_var(name)->get_att("long_name")->as_string(0);
         this->ScalarVariableMap[varname] = std::string(name);
 
         // Add it to the point grid
@@ -1850,21 +4039,25 @@ void vtkEnlilReader::addPointArray(char* name)
         std::cerr << "Failed to retrieve variable " << name
                   << ". Verify variable name." << std::endl;
 
-        file.close();
         return;
     }
-
-    file.close();
 }
 
 //---------------------------------------------------------------------------------------------
 void vtkEnlilReader::addPointArray(char* name1, char* name2, char* name3)
 {
-    NcFile file(this->FileName);
+    QMutexLocker library(&readerFilePool::libraryLock());
+
+    NcFile* file = this->FilePool.getFile(this->FileName);
+    if(file == NULL)
+    {
+        return;
+    }
+
     try
     {
         //get the long name of the first variable in the vector
-        std::string varname1 = file.get_var(name1)->get_att("long_name")->as_string(0);
+        std::string varname1 = file->get_var(name1)->get_att("long_name")->as_string(0);
 
         //remove the vector component of the name
         size_t pos = varname1.find("-");
@@ -1893,10 +4086,8 @@ void vtkEnlilReader::addPointArray(char* name1, char* name2, char* name3)
                   << name1 << " or " << name2 << " or " << name3
                   << ". Verify variable names." << std::endl;
 
-        file.close();
         return;
     }
-    file.close();
 }
 
 //---------------------------------------------------------------------------------------------
@@ -1912,9 +4103,9 @@ int vtkEnlilReader::GenerateGrid()
 
     const int GridScale = this->GetGridScaleType();
 
-    double *X1;
-    double *X2;
-    double *X3;
+    double *X1 = NULL;
+    double *X2 = NULL;
+    double *X3 = NULL;
 
     int X1_extents[2] = {this->SubExtent[0], this->SubExtent[1]};
     int X2_extents[2] = {this->SubExtent[2], this->SubExtent[3]};
@@ -1927,8 +4118,9 @@ int vtkEnlilReader::GenerateGrid()
         this->sphericalGridCoords.clear();
 
 
-        //build the Grid
+        //build the Grid (single precision points)
         this->Points = vtkSmartPointer<vtkPoints>::New();
+        this->Points->SetDataTypeToFloat();
 
         //build the Radius Array
         this->Radius = vtkSmartPointer<vtkFloatArray>::New();
@@ -1940,6 +4132,16 @@ int vtkEnlilReader::GenerateGrid()
         X2 = this->readGridPartialToArray((char*)"X2", X2_extents, false);
         X3 = this->readGridPartialToArray((char*)"X3", X3_extents, true);
 
+        if(X1 == NULL || X2 == NULL || X3 == NULL)
+        {
+            std::cerr << "Failed to read grid from " << this->FileName << std::endl;
+
+            delete [] X1;
+            delete [] X2;
+            delete [] X3;
+            return 0;
+        }
+
         // Populate the Spherical Grid Coordinates (to be used in calcs later)
         std::vector<double> R(X1, X1 + this->SubDimension[0]);
         std::vector<double> T(X2, X2 + this->SubDimension[1]);
@@ -1949,35 +4151,91 @@ int vtkEnlilReader::GenerateGrid()
         this->sphericalGridCoords.push_back(T);
         this->sphericalGridCoords.push_back(P);
 
-        // Generate the grid based on the R-P-T coordinate system.
-        double xyz[3] = { 0, 0, 0 };
+        // trig tables for the angles, shared by the grid and vector conversions
+        this->sinTheta.resize(this->SubDimension[1]);
+        this->cosTheta.resize(this->SubDimension[1]);
+        for (j = 0; j < this->SubDimension[1]; j++)
+        {
+            this->sinTheta[j] = sin(X2[j]);
+            this->cosTheta[j] = cos(X2[j]);
+        }
+
+        this->sinPhi.resize(this->SubDimension[2]);
+        this->cosPhi.resize(this->SubDimension[2]);
         for (k = 0; k < this->SubDimension[2]; k++)
         {
-            for (j = 0; j < this->SubDimension[1]; j++)
-            {
-                for (i = 0; i < this->SubDimension[0]; i++)
-                {
-                    xyz[0] = (X1[i] * sin(X2[j]) * cos(X3[k]))
-                            / GRID_SCALE::ScaleFactor[GridScale];
-                    xyz[1] = (X1[i] * sin(X2[j]) * sin(X3[k]))
-                            / GRID_SCALE::ScaleFactor[GridScale];
-                    xyz[2] = (X1[i] * cos(X2[j]))
-                            / GRID_SCALE::ScaleFactor[GridScale];
-
-                    //insert point information into the grid
-                    this->Points->InsertNextPoint(xyz);
-
-                    // insert radius value into radius array.
-                    // Scaled by grid scale factor
-                    this->Radius->InsertNextValue(
-                                X1[i] / GRID_SCALE::ScaleFactor[GridScale]);
-                }
-            }
+            this->sinPhi[k] = sin(X3[k]);
+            this->cosPhi[k] = cos(X3[k]);
+        }
+
+        // size the grid and radius once
+        vtkIdType numPoints = (vtkIdType)this->SubDimension[0]*this->SubDimension[1]*this->SubDimension[2];
+        this->Radius->SetNumberOfTuples(numPoints);
+
+        if(this->ImplicitPoints)
+        {
+            // x/y/z are computed from the axes when asked for
+            this->Points->SetData(vtkSmartPointer<vtkEnlilGridPoints>::New());
+        }
+        else
+        {
+            this->Points->SetNumberOfPoints(numPoints);
         }
 
-        //grid just created, so clean by definition.
+        //free temporary memory
+        delete [] X1; X1 = NULL;
+        delete [] X2; X2 = NULL;
+        delete [] X3; X3 = NULL;
+
+        //grid just created, so clean by definition.  It is filled below.
         this->gridClean=true;
+        this->GridScaleBuilt = -1;
+    }
+
+    //fill the points and radius at the grid scale.  When only the scale changed, the
+    // unscaled axes and trig tables are still here, so the arrays are refilled in
+    // place without reading the files or calling any trig functions.
+    if(this->GridScaleBuilt != GridScale)
+    {
+        // scaled radii are the same for every theta/phi
+        const std::vector<double> &R = this->sphericalGridCoords[0];
+        std::vector<double> scaledR(R.size());
+        for (i = 0; i < (int)R.size(); i++)
+        {
+            scaledR[i] = R[i] / GRID_SCALE::ScaleFactor[GridScale];
+        }
+
+        float* points = NULL;
+        vtkEnlilGridPoints* implicitPoints = vtkEnlilGridPoints::SafeDownCast(this->Points->GetData());
+        if(implicitPoints != NULL)
+        {
+            implicitPoints->SetAxes(scaledR, this->sinTheta, this->cosTheta, this->sinPhi, this->cosPhi);
+        }
+        else
+        {
+            points = static_cast<float*>(this->Points->GetData()->GetVoidPointer(0));
+        }
+
+        // Generate the grid based on the R-P-T coordinate system.
+        enlilGridBuilder builder;
+        builder.R = &scaledR[0];
+        builder.sinTheta = &this->sinTheta[0];
+        builder.cosTheta = &this->cosTheta[0];
+        builder.sinPhi   = &this->sinPhi[0];
+        builder.cosPhi   = &this->cosPhi[0];
+        builder.dimI = this->SubDimension[0];
+        builder.dimJ = this->SubDimension[1];
+        builder.points = points;
+        builder.radius = this->Radius->GetPointer(0);
+
+        vtkSMPTools::For(0, this->SubDimension[2], builder);
+
+        this->Points->Modified();
+        this->Radius->Modified();
+
+        this->GridScaleBuilt = GridScale;
     }
+
     return 1;
 }
 
@@ -1985,19 +4243,252 @@ int vtkEnlilReader::GenerateGrid()
 
 
 
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::SetCacheSize(int _arg)
+{
+    if(_arg < 0)
+    {
+        _arg = 0;
+    }
+
+    QMutexLocker locker(&this->ReadLock);
+
+    //shrinking evicts the least recently used arrays right away
+    this->CacheSize = _arg;
+    this->CacheBudget.setMaximumSize((double)_arg*1024.0*1024.0);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::SetCacheCompression(int _arg)
+{
+    _arg = std::max(0, std::min(_arg, 90));
+
+    QMutexLocker locker(&this->ReadLock);
+
+    //a smaller share drops the least recently used compressed arrays right away
+    this->CacheCompression = _arg;
+    this->CacheBudget.setCompressedShare(_arg/100.0);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::SetPrefetch(int _arg)
+{
+    this->Prefetch = _arg;
+
+    if(!this->Prefetch && this->Prefetcher != NULL)
+    {
+        this->Prefetcher->cancel();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::SetResolution(int _arg)
+{
+    if(_arg < 1)
+    {
+        _arg = 1;
+    }
+
+    if(this->Resolution != _arg)
+    {
+        //the prefetcher reads at the current resolution
+        this->Prefetcher->cancel();
+        QMutexLocker locker(&this->ReadLock);
+
+        //cached arrays are keyed by stride, so going back keeps them
+        this->Resolution = _arg;
+        this->gridClean = false;
+        this->Modified();
+    }
+}
+
 //---------------------------------------------------------------------------------------------
 //=================== Cache Control Methods ====================
 void vtkEnlilReader::cleanCache()
 {
+    //don't pull the cache out from under the prefetcher
+    QMutexLocker locker(&this->ReadLock);
 
     std::cout << "Cleaning Cache..." << std::endl;
 
+    this->CurrentArrays.clear();
+    this->OutputArrays.clear();
+
     this->pDensityCache.cleanCache();
     this->cDensityCache.cleanCache();
     this->polarityCache.cleanCache();
     this->temperatureCache.cleanCache();
     this->velocityCache.cleanCache();
     this->bFieldCache.cleanCache();
+
+    for(int x = 0; x < DERIVED::NUMBER; x++)
+    {
+        this->derivedCache[x].cleanCache();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::ReleaseCurrentArrays()
+{
+    QMutexLocker locker(&this->ReadLock);
+
+    this->CurrentArrays.clear();
+    this->OutputArrays.clear();
+    this->BracketArrays.clear();
+    this->Modified();
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::cleanDerivedCache(int type)
+{
+    QMutexLocker locker(&this->ReadLock);
+
+    this->derivedCache[type].cleanCache();
+    this->CurrentArrays.erase(DERIVED::Names[type]);
+    this->OutputArrays.erase(DERIVED::Names[type]);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::schedulePrefetch(double requestedTime)
+{
+    //find the index of the requested step
+    int index = 0;
+    while(index < this->NumberOfTimeSteps-1 && this->TimeSteps[index] < requestedTime)
+    {
+        index++;
+    }
+
+    int stride = (this->lastStepIndex < 0) ? 0 : index - this->lastStepIndex;
+
+    //same step again (e.g. an array was toggled); keep whatever is in flight
+    if(stride == 0 && this->lastStepIndex >= 0)
+    {
+        return;
+    }
+
+    //single steps, or a repeat of the last stride, look like playback.
+    // Anything else is a jump, so stop reading ahead.
+    bool playing = (stride == 1 || stride == -1 || stride == this->lastStepStride);
+    int nextIndex = index + stride;
+
+    this->lastStepIndex = index;
+    this->lastStepStride = stride;
+
+    if(!this->Prefetch || !playing || nextIndex < 0 || nextIndex >= this->NumberOfTimeSteps)
+    {
+        this->Prefetcher->cancel();
+        return;
+    }
+
+    //prefetch the currently selected arrays for the current extents
+    std::vector<std::string> arrays;
+    for(int c = 0; c < this->PointDataArraySelection->GetNumberOfArrays(); c++)
+    {
+        const char* name = this->PointDataArraySelection->GetArrayName(c);
+        if(this->PointDataArraySelection->ArrayIsEnabled(name))
+        {
+            arrays.push_back(std::string(name));
+        }
+    }
+
+    if(arrays.empty())
+    {
+        return;
+    }
+
+    this->Prefetcher->requestTimeStep(this->TimeSteps[nextIndex], arrays, this->SubExtent);
+}
+
+//---------------------------------------------------------------------------------------------
+void vtkEnlilReader::prefetchTimeStep(double time, const std::vector<std::string> &arrays, const int extents[])
+{
+    RCache::extents subExtents(extents);
+    subExtents.setStride(this->Resolution);
+
+    for(size_t x = 0; x < arrays.size(); x++)
+    {
+        //let go of the lock between arrays so RequestData never waits long
+        if(this->Prefetcher->isCancelled())
+        {
+            return;
+        }
+
+        QMutexLocker locker(&this->ReadLock);
+
+        //the grid (and trig/radius data) must still match what we were asked for
+        if(!this->gridClean || !this->eq(this->SubExtent, (int*)extents)
+                || this->time2fileMap.find(time) == this->time2fileMap.end())
+        {
+            return;
+        }
+
+        int dataID = 0;
+        this->getDataID(arrays[x], dataID);
+
+        RCache::ReaderCache* arrayCache = this->getArrayCache(dataID);
+        if(arrayCache == NULL || arrayCache->getExtentsFromCache(time, subExtents) != NULL)
+        {
+            continue;
+        }
+
+        //point the read paths at the prefetch file
+        char* savedFileName = this->FileName;
+        double savedMJD = this->current_MJD;
+        int savedRecord = this->CurrentRecord;
+
+        this->FileName = (char*)this->time2fileMap[time].c_str();
+        this->current_MJD = time;
+        this->CurrentRecord = this->time2recordMap[time];
+
+        vtkSmartPointer<vtkFloatArray> DataArray = vtkSmartPointer<vtkFloatArray>::New();
+        DataArray->SetName(arrays[x].c_str());
+
+        if(this->VectorVariableMap.find(arrays[x]) != this->VectorVariableMap.end())
+        {
+            this->readVector(arrays[x], DataArray, NULL, dataID);
+        }
+        else
+        {
+            this->readScalar(NULL, DataArray, arrays[x], NULL, dataID);
+        }
+
+        if(DataArray->GetNumberOfTuples() == subExtents.getNumberOfPoints())
+        {
+            arrayCache->addCacheElement(time, subExtents, DataArray);
+        }
+
+        this->FileName = savedFileName;
+        this->current_MJD = savedMJD;
+        this->CurrentRecord = savedRecord;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+RCache::ReaderCache* vtkEnlilReader::getArrayCache(int dataID)
+{
+    switch(dataID)
+    {
+    case DATA_TYPE::PDENSITY:
+        return &this->pDensityCache;
+
+    case DATA_TYPE::CDENSITY:
+        return &this->cDensityCache;
+
+    case DATA_TYPE::TEMP:
+        return &this->temperatureCache;
+
+    case DATA_TYPE::POLARITY:
+        return &this->polarityCache;
+
+    case DATA_TYPE::BFIELD:
+        return &this->bFieldCache;
+
+    case DATA_TYPE::VELOCITY:
+        return &this->velocityCache;
+
+    default:
+        return NULL;
+    }
 }
 
 
@@ -2017,6 +4508,11 @@ int vtkEnlilReader::FillOutputPortInformation(int port, vtkInformation* info)
 
     }
 
+    if (port==1)
+    {
+        info->Set(vtkDataObject::DATA_TYPE_NAME(), "vtkPolyData");
+    }
+
     return 1;
 }
 
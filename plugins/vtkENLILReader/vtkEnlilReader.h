@@ -6,11 +6,13 @@
 #include "vtkIOParallelNetCDFModule.h" // For export macro
 //#include "cxform.h"
 #include "readerCache.h"
+#include "readerFilePool.h"
 #include "vtkSmartPointer.h"
 #include<map>
 #include<string>
 #include<vector>
 #include<QString>
+#include<QMutex>
 
 
 class vtkDataArraySelection;
@@ -24,6 +26,8 @@ class vtkPoints;
 class vtkTable;
 class vtkStructuredGrid;
 class vtkStructuredGridAlgorithm;
+class readerCacheManager;
+class readerMappedFile;
 
 
 namespace GRID_SCALE
@@ -45,6 +49,9 @@ namespace UNITS
 static const double emu = 1.67262158e-27;
 static const double km2cm = 1e6;
 static const double km2m = 1e3;
+static const double kb = 1.3806503e-23;
+static const double mu0 = 4.0e-7*3.14159265358979323846;
+static const double Pa2nPa = 1e9;
 }
 
 namespace DATA_TYPE
@@ -61,6 +68,35 @@ enum dataType{
 
 }
 
+namespace OUTPUT_MODE
+{
+//what part of the grid is read
+enum outputMode{
+    VOLUME     = 0,
+    EQUATORIAL = 1,   // theta plane closest to pi/2
+    MERIDIONAL = 2,   // phi plane closest to MeridionalLongitude
+    SPHERE     = 3    // r sphere closest to SphereRadius
+};
+}
+
+namespace DERIVED
+{
+//quantities computed from the file variables while they are read
+enum derivedType{
+    BMAG = 0,     // |B|
+    VMAG = 1,     // |V|
+    PDYN = 2,     // dynamic pressure  D V^2
+    BETA = 3,     // plasma beta  n kb T / (B^2 / 2 mu0)
+    NR2  = 4,     // number density normalized by radius  n r^2
+    NUMBER = 5
+};
+static const char* Names[NUMBER] = { "Magnetic Field Magnitude",
+                                     "Velocity Magnitude",
+                                     "Dynamic Pressure",
+                                     "Plasma Beta",
+                                     "Normalized Number Density (n r^2)" };
+}
+
 
 /** READER PRIME **/
 class VTKIOPARALLELNETCDF_EXPORT vtkEnlilReader : public vtkStructuredGridAlgorithm
@@ -73,28 +109,89 @@ public:
     void PrintSelf(ostream &os, vtkIndent indent);
 
     // Set/get macros
-    void SetGridScaleType(int value)
-    {
-        this->GridScaleType = value;
-        this->gridClean = false;
-        this->Modified();
-    }
-
+    void SetGridScaleType(int value);
     vtkGetMacro(GridScaleType, int)
 
 
-    void SetDataUnits(int _arg)
-    {
+    // Description:
+    // Native (0) or SWPC (1) units.  Arrays are read and cached in native units and
+    // converted on output, so switching units does not read the files again.
+    void SetDataUnits(int _arg);
 
-        std::cout << "Updating Units: " << std::endl;
-        this->DataUnits = _arg;
-        this->cleanCache();
+    vtkGetMacro(DataUnits, int)
 
-        this->gridClean=false;
-        this->Modified();
+    // Description:
+    // Maximum amount of memory (in MB) used to cache data arrays across time steps.
+    void SetCacheSize(int _arg);
+    vtkGetMacro(CacheSize, int)
+
+    // Description:
+    // Percentage of the cache that may hold compressed arrays.  Arrays that would be
+    // evicted are compressed instead, and inflated again when revisited.  0 disables it.
+    void SetCacheCompression(int _arg);
+    vtkGetMacro(CacheCompression, int)
+
+    // Description:
+    // When on, the next time step in the direction of play is read into the
+    // cache in the background while the current one is rendered.
+    void SetPrefetch(int _arg);
+    vtkGetMacro(Prefetch, int)
+
+    // Description:
+    // Read every Nth point in r, theta and phi (1 = full resolution).  Coarse
+    // reads use strided hyperslabs, for a quick preview of large runs.
+    void SetResolution(int _arg);
+    vtkGetMacro(Resolution, int)
+
+    // Description:
+    // Forget the arrays kept from the last update (the array cache is kept), so the
+    // next update reads them again even if the request did not change.
+    void ReleaseCurrentArrays();
+
+    // Description:
+    // Read the whole volume (VOLUME) or a single index plane: the equatorial plane,
+    // a meridional half plane at MeridionalLongitude (degrees) or the sphere at
+    // SphereRadius (AU).  Plane modes only read that plane from the files.
+    vtkSetClampMacro(OutputMode, int, OUTPUT_MODE::VOLUME, OUTPUT_MODE::SPHERE)
+    vtkGetMacro(OutputMode, int)
+
+    vtkSetMacro(MeridionalLongitude, double)
+    vtkGetMacro(MeridionalLongitude, double)
+
+    vtkSetMacro(SphereRadius, double)
+    vtkGetMacro(SphereRadius, double)
+
+    // Description:
+    // When on, the grid points are computed on demand from the three axes
+    // (vtkEnlilGridPoints) instead of being stored as explicit x/y/z.
+    void SetImplicitPoints(int _arg)
+    {
+        if(this->ImplicitPoints != _arg)
+        {
+            this->ImplicitPoints = _arg;
+            this->gridClean = false;
+            this->Modified();
+        }
     }
+    vtkGetMacro(ImplicitPoints, int)
 
-    vtkGetMacro(DataUnits, int)
+    // Description:
+    // When on, the output is a reduction over every time step of the run instead of a
+    // single step: the maximum, mean and arrival time of each selected point array (the
+    // magnitude of vectors).  A point arrives (in hours after the first step) when its
+    // value first reaches ArrivalFactor times its value at the first step.
+    vtkSetMacro(TemporalReduction, int)
+    vtkGetMacro(TemporalReduction, int)
+
+    vtkSetMacro(ArrivalFactor, double)
+    vtkGetMacro(ArrivalFactor, double)
+
+    // Description:
+    // When on, a time between two time steps gives a linear blend of the two (instead of
+    // the nearest step).  Both steps go through the array cache, so animating at a finer
+    // cadence than the run was written at reads every step once.
+    vtkSetMacro(TemporalInterpolation, int)
+    vtkGetMacro(TemporalInterpolation, int)
 
 
     vtkSetStringMacro(FileName)
@@ -123,6 +220,14 @@ public:
     void DisableAllPointArrays();
     void DisableAllCellArrays();
 
+    // Description:
+    // Derived quantities (|B|, |V|, dynamic pressure, plasma beta, n r^2) are
+    // computed in the same pass that reads and converts D, T, B and V.
+    int GetNumberOfDerivedArrays();
+    const char* GetDerivedArrayName(int index);
+    int  GetDerivedArrayStatus(const char* name);
+    void SetDerivedArrayStatus(const char* name, int status);
+
     void EnableAllPointArrays();
     void EnableAllCellArrays();
 
@@ -134,6 +239,15 @@ public:
     vtkGetStringMacro(CurrentFileName);
 
 
+    // Description:
+    // Time series of the selected point arrays at locations, given as (r, theta, phi)
+    // triples: r in units of the grid scale, colatitude and longitude in degrees.  Only
+    // the 8 grid points around each location are read from every time step, and the
+    // steps are read in parallel.  The table has a "Time" column (seconds, the TIME of
+    // the files), an "MJD" column and one column per array and location.  Call after
+    // UpdateInformation.  Returns 0 on failure.
+    int ExtractPointTimeSeries(const std::vector<double> &locations, vtkTable* output);
+
     void readVector(std::string array, vtkFloatArray *DataArray, vtkInformationVector* outputVector, const int &dataID);
     void readScalar(vtkStructuredGrid *Data, vtkFloatArray *DataArray, std::string array, vtkInformationVector* outputVector, int dataID);
     void getDataID(std::string array, int &dataID);
@@ -145,7 +259,19 @@ protected:
     char* FileName;            // Base file name
     int GridScaleType;
     int DataUnits;
+    int CacheSize;
+    int CacheCompression;
+    int Prefetch;
+    int Resolution;
+    int OutputMode;
+    double MeridionalLongitude;
+    double SphereRadius;
+    int ImplicitPoints;
+    int TemporalReduction;
+    double ArrivalFactor;
+    int TemporalInterpolation;
     bool gridClean;
+    int GridScaleBuilt;         // GridScaleType the Points and Radius are filled at
     int numberOfArrays;
 
     // Extent information
@@ -155,7 +281,8 @@ protected:
     int WholeExtent[6];       // Extents of entire grid
     int SubExtent[6];         // Processor grid extent
     int UpdateExtent[6];
-    int Dimension[3];         // Size of entire grid
+    int Dimension[3];         // Size of entire grid (at the current Resolution)
+    int FileDimension[3];     // Size of the grid in the file (phi without the periodic plane)
     int SubDimension[3];      // Size of processor grid
 
     // Check to see if info is clean
@@ -165,21 +292,53 @@ protected:
     vtkSmartPointer<vtkPoints> Points;        // Structured grid geometry
     vtkSmartPointer<vtkFloatArray> Radius;   // Radius Grid Data
 
+    // Arrays already produced for the current file, record, extent and resolution (by
+    // name, in native units).  A change of selection only reads the newly enabled arrays;
+    // the others are handed out again without going to the cache or the files.
+    // OutputArrays hold those of them that had to be converted to DataUnits.
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> > CurrentArrays;
+    std::map<std::string, vtkSmartPointer<vtkFloatArray> > OutputArrays;
+    std::string CurrentArraysFile;
+    int CurrentArraysRecord;
+    int CurrentArraysExtent[6];
+    int CurrentArraysResolution;
+
+    // Output arrays of the two time steps of the last interpolation bracket (by MJD, then
+    // name), kept while the extent and the reader's settings (its MTime) are unchanged,
+    // so frames between the same two steps only blend.  BracketCurrent is the step that
+    // CurrentArrays were last produced for.
+    std::map<double, std::map<std::string, vtkSmartPointer<vtkFloatArray> > > BracketArrays;
+    int BracketExtent[6];
+    unsigned long BracketMTime;
+    double BracketCurrent;
+
     std::vector<std::string> MetaDataNames;
     std::map<std::string, std::string> ScalarVariableMap;
     std::map<std::string, std::vector<std::string> > VectorVariableMap;
     std::vector<std::vector<double> > sphericalGridCoords;
 
+    // trig tables of the grid angles (per theta and per phi index of SubExtent)
+    std::vector<double> sinTheta;
+    std::vector<double> cosTheta;
+    std::vector<double> sinPhi;
+    std::vector<double> cosPhi;
+
     std::string dateString;
     std::vector<std::string> fileNames;
 
     std::map<double,std::string> time2fileMap;
     std::map<double,double> time2physicaltimeMap;
     std::map<double,std::string> time2datestringMap;
+    std::map<double,int> time2recordMap;    // record of the time step in its file (containers)
 
-    //this map holds the positions of artifacts based on time step
+    //this map holds the positions of artifacts based on time step (HEEQ, meters),
+    // computed for the whole run by calculateArtifacts
     std::map< double, std::map<std::string, std::vector<double> > > positions;
 
+    // Play direction tracking for prefetching
+    int lastStepIndex;
+    int lastStepStride;
+
     // Time step information
     int NumberOfTimeSteps;                 // Number of time steps
     std::vector<double> TimeSteps;        // Actual times available for request
@@ -191,11 +350,13 @@ protected:
     bool timesCalulated;
 
     char* CurrentFileName;
+    int CurrentRecord;
     void SetCurrentFileName(const char* fname);
 
     // Selected field of interest
     vtkDataArraySelection* PointDataArraySelection;
     vtkDataArraySelection* CellDataArraySelection;
+    vtkDataArraySelection* DerivedDataArraySelection;
 
     // Observer to modify this object when array selections are modified
     vtkCallbackCommand* SelectionObserver;
@@ -205,6 +366,28 @@ protected:
     int GenerateGrid();
     int LoadVariableData(vtkInformationVector *outputVector);
     int LoadArrayValues(std::string array, vtkInformationVector* outputVector);
+    int LoadDerivedArrays(vtkInformationVector* outputVector, std::vector<std::string> &fusedArrays);
+    int LoadTemporalReduction(vtkInformationVector* outputVector);
+    int LoadInterpolatedData(vtkInformationVector* outputVector, double earlier, double later, double weight);
+    vtkSmartPointer<vtkFloatArray> newFusedArray(const char* variable, bool needed, RCache::extents &xtents, int components);
+    vtkSmartPointer<vtkFloatArray> getResidentArray(const char* variable, RCache::extents &xtents);
+    std::string getArrayNameOfVariable(const char* variable);
+    void cleanDerivedCache(int type);
+
+    //forgets CurrentArrays if they were produced for another request
+    void validateCurrentArrays();
+
+    //adds the current array called name to Data, returns false if there is none
+    bool addCurrentArray(vtkStructuredGrid* Data, const std::string &name);
+
+    //conversion of array name from native units to DataUnits (false if there is none)
+    bool getUnitConversion(const std::string &name, double &factor, bool &byRadius);
+
+    //native array of the SubExtent in DataUnits (a copy, or converted in place)
+    vtkSmartPointer<vtkFloatArray> toDataUnits(vtkFloatArray* native, bool inPlace = false);
+
+    //adds native to Data in DataUnits
+    void addOutputArray(vtkStructuredGrid* Data, vtkFloatArray* native);
 
     void PopulateGridData();
 
@@ -225,20 +408,38 @@ protected:
 
     // Request Information Helpers
     double getRequestedTime(vtkInformationVector *outputVector);
+    bool getInterpolationBracket(vtkInformationVector *outputVector, double &earlier, double &later, double &weight);
+    void setCurrentTimeStep(double time);
+    int getUpdateExtent(vtkInformation* outInfo, int updateExtent[6], int pieceExtent[6], int &ghostLevels);
+    int restrictToOutputPlane();
     int PopulateArrays();
     int LoadMetaData(vtkInformationVector* outputVector);
     int calculateTimeSteps();
+    int calculateContainerTimeSteps(const std::string &fileName);
     int checkStatus(void* Object, char* name);
 
     void calculateArtifacts();
+    int LoadArtifacts(vtkInformationVector* outputVector);
 
-    double* read3dPartialToArray(char *array, int extents[]);
+    int readVariableToFloat(const char *arrayName, int extents[], float *output);
+    bool readMappedToFloat(readerMappedFile* mapped, const char *arrayName, int extents[], float *output);
+    int getPlanesPerChunk();
     double* readGridPartialToArray(char *arrayName, int subExtents[], bool periodic);
     void loadVarMetaData(const char *array,
                          const char *title,
                          vtkInformationVector* outputVector,
                          bool vector = false);
 
+    // Meta-data never changes for a given file, so the attributes are parsed once
+    // per file into field data arrays that are shared by every output of that file.
+    struct metaDataRecord
+    {
+        std::vector<vtkSmartPointer<vtkAbstractArray> > fileArrays;
+        std::map<std::string, std::vector<vtkSmartPointer<vtkAbstractArray> > > variableArrays;
+    };
+    std::map<std::string, metaDataRecord> MetaDataRecords;
+    metaDataRecord* getMetaDataRecord(const std::string &fileName);
+
 
     void addPointArray(char* name);
     void addPointArray(char* name1, char* name2, char* name3);
@@ -271,19 +472,46 @@ protected:
 
     virtual int FillOutputPortInformation(int, vtkInformation*);
 
+    //predict the next time step from the play direction and queue it for prefetching
+    void schedulePrefetch(double requestedTime);
+
+    //called from the prefetch thread: reads arrays for time into the cache
+    void prefetchTimeStep(double time, const std::vector<std::string> &arrays, const int extents[6]);
+    friend class readerCacheManager;
+
+    //called from the reduction read thread: reads arrays of time into buffers
+    bool readReductionStep(double time, const std::vector<std::string> &arrays,
+                           std::vector<vtkSmartPointer<vtkFloatArray> > &buffers);
+    friend class enlilReductionReader;
 
 private:
 
+    //background reader for the predicted next time step
+    readerCacheManager* Prefetcher;
+
+    //serializes all file access and reader state between RequestData and the prefetcher
+    QMutex ReadLock;
+
+    //open NetCDF files shared by all read paths
+    readerFilePool FilePool;
+
     //Caching implimentation
+    // the budget is shared by all array caches and must outlive them
+    RCache::cacheBudget CacheBudget;
+
     RCache::ReaderCache pDensityCache;
     RCache::ReaderCache cDensityCache;
     RCache::ReaderCache temperatureCache;
     RCache::ReaderCache polarityCache;
     RCache::ReaderCache bFieldCache;
     RCache::ReaderCache velocityCache;
+    RCache::ReaderCache derivedCache[DERIVED::NUMBER];
 
     void cleanCache();
 
+    //returns the cache used for the given DATA_TYPE (NULL if none)
+    RCache::ReaderCache* getArrayCache(int dataID);
+
 
     vtkEnlilReader(const vtkEnlilReader&);  // Not implemented.
     void operator=(const vtkEnlilReader&);  // Not implemented.